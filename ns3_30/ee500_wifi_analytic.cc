@@ -0,0 +1,526 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "ee500_wifi_analytic.h"
+#include "ee500_wifi_scenario.h"
+#include "ee500_wifi_topology.h"
+
+// Modulation of a rate, it decides the preamble and the symbol length
+enum RateFamily
+{
+  RATE_DSSS,
+  RATE_OFDM,
+  RATE_HT,
+  RATE_VHT,
+  RATE_HE
+};
+
+// A rate of the PHY and the SNR it needs for a packet error rate of a few percent
+struct AnalyticRate
+{
+  RateFamily family;
+  double rate; // Mbps
+  double snr;  // dB
+};
+
+// 20 MHz, one spatial stream, long guard interval (3.2 us for HE, the ns-3 default)
+static const double DSSS_RATES[] = {1, 2, 5.5, 11};
+static const double DSSS_SNR[] = {1, 4, 6, 9};
+static const double OFDM_RATES[] = {6, 9, 12, 18, 24, 36, 48, 54};
+static const double OFDM_SNR[] = {3, 5, 6, 9, 12, 16, 20, 22};
+static const double HT_RATES[] = {6.5, 13, 19.5, 26, 39, 52, 58.5, 65, 78, 86.7};
+static const double HE_RATES[] = {7.3, 14.6, 21.9, 29.3, 43.9, 58.5, 65.8, 73.1, 87.8, 97.5, 109.7, 121.9};
+static const double MCS_SNR[] = {3, 6, 9, 11, 15, 19, 21, 22, 27, 29, 32, 35};
+
+static const double RX_SENSITIVITY = -101;  // dBm, the YansWifiPhy default
+static const double NOISE_FIGURE = 7;       // dB, the YansWifiPhy default
+static const uint32_t QUEUE_SIZE = 500;     // packets, the WifiMacQueue default
+static const uint32_t RETRY_LIMIT = 7;      // attempts of a frame that is never acknowledged
+static const uint32_t BLOCK_ACK_WINDOW = 64;
+static const double MAX_AMPDU_SIZE = 65535; // bytes
+static const double MAX_PPDU_DURATION = 5.484e-3;
+static const double BEACON_SIZE = 150;      // bytes, with the HT/VHT/HE elements
+
+// Data subcarriers of a channel width over the ones of 20 MHz
+static double GetWidthFactor(RateFamily family, double channelWidth)
+{
+  if (family == RATE_HE)
+  {
+    return channelWidth >= 160 ? 1960.0 / 234 : channelWidth >= 80 ? 980.0 / 234 : channelWidth >= 40 ? 468.0 / 234 : 1.0;
+  }
+  if (family == RATE_HT || family == RATE_VHT)
+  {
+    return channelWidth >= 160 ? 468.0 / 52 : channelWidth >= 80 ? 234.0 / 52 : channelWidth >= 40 ? 108.0 / 52 : 1.0;
+  }
+  return 1.0;
+}
+
+// The rates rate control can pick from, slowest first. A constant rate is the only one,
+// an empty list means the rate is unknown.
+static std::vector<AnalyticRate> GetRates(const WifiScenarioConfig &config)
+{
+  const std::string &standard = config.standard;
+  RateFamily family = RATE_HT;
+  if (standard == "b")
+  {
+    family = RATE_DSSS;
+  }
+  else if (standard == "a" || standard == "g")
+  {
+    family = RATE_OFDM;
+  }
+  else if (standard == "ac")
+  {
+    family = RATE_VHT;
+  }
+  else if (standard == "ax" || standard == "ax24")
+  {
+    family = RATE_HE;
+  }
+  // Minstrel only uses the legacy rates
+  if (config.rateControl == "minstrel" && family != RATE_DSSS)
+  {
+    family = RATE_OFDM;
+  }
+
+  std::vector<AnalyticRate> rates;
+  if (family == RATE_DSSS)
+  {
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+      rates.push_back({RATE_DSSS, DSSS_RATES[i], DSSS_SNR[i]});
+    }
+  }
+  else if (family == RATE_OFDM)
+  {
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+      rates.push_back({RATE_OFDM, OFDM_RATES[i], OFDM_SNR[i]});
+    }
+  }
+  else
+  {
+    // MCS 9 of VHT is only valid above 20 MHz with one stream, HT stops at MCS 7
+    uint32_t mcsNum = family == RATE_HE ? 12 : family == RATE_VHT ? (config.channelWidth > 20 ? 10 : 9) : 8;
+    double factor = GetWidthFactor(family, config.channelWidth);
+    for (uint32_t i = 0; i < mcsNum; ++i)
+    {
+      double rate = (family == RATE_HE ? HE_RATES[i] : HT_RATES[i]) * factor;
+      rates.push_back({family, rate, MCS_SNR[i]});
+    }
+  }
+  if (config.rateControl != "constant")
+  {
+    return rates;
+  }
+
+  // DsssRate5_5Mbps, OfdmRate24Mbps, ErpOfdmRate54Mbps, HtMcs7, VhtMcs8, HeMcs11, ...
+  const std::string &phyRate = config.phyRate;
+  std::vector<AnalyticRate> constant;
+  size_t mcs = phyRate.find("Mcs");
+  if (mcs != std::string::npos)
+  {
+    std::string prefix = phyRate.substr(0, mcs);
+    RateFamily mcsFamily = prefix == "Ht" ? RATE_HT : prefix == "Vht" ? RATE_VHT : RATE_HE;
+    uint32_t index = std::atoi(phyRate.c_str() + mcs + 3);
+    if ((prefix == "Ht" && index < 8) || (prefix == "Vht" && index < 10) || (prefix == "He" && index < 12))
+    {
+      double rate = (mcsFamily == RATE_HE ? HE_RATES[index] : HT_RATES[index]) * GetWidthFactor(mcsFamily, config.channelWidth);
+      constant.push_back({mcsFamily, rate, MCS_SNR[index]});
+    }
+    return constant;
+  }
+  size_t begin = phyRate.find("Rate");
+  size_t end = phyRate.find("Mbps");
+  if (begin == std::string::npos || end == std::string::npos || end < begin + 4)
+  {
+    return constant;
+  }
+  std::string value = phyRate.substr(begin + 4, end - begin - 4);
+  std::replace(value.begin(), value.end(), '_', '.');
+  double rate = std::atof(value.c_str());
+  RateFamily legacy = phyRate.find("Dsss") == 0 ? RATE_DSSS : RATE_OFDM;
+  const double *table = legacy == RATE_DSSS ? DSSS_RATES : OFDM_RATES;
+  const double *snr = legacy == RATE_DSSS ? DSSS_SNR : OFDM_SNR;
+  for (uint32_t i = 0; i < (legacy == RATE_DSSS ? 4u : 8u); ++i)
+  {
+    if (table[i] == rate)
+    {
+      constant.push_back({legacy, rate, snr[i]});
+    }
+  }
+  return constant;
+}
+
+// Airtime of a PPDU of the given size in seconds, preamble included
+static double GetPpduDuration(const AnalyticRate &rate, double bytes)
+{
+  if (rate.family == RATE_DSSS)
+  {
+    return 192e-6 + bytes * 8 / (rate.rate * 1e6);
+  }
+  double preamble = rate.family == RATE_OFDM ? 20e-6 : rate.family == RATE_HT ? 36e-6 : rate.family == RATE_VHT ? 40e-6 : 44e-6;
+  double symbol = rate.family == RATE_HE ? 16e-6 : 4e-6;
+  // SERVICE and tail bits
+  double bits = 16 + 8 * bytes + 6;
+  return preamble + std::ceil(bits / (rate.rate * 1e6 * symbol)) * symbol;
+}
+
+// The basic rate control responses are sent at, the fastest one not above the data rate
+static AnalyticRate GetControlRate(const AnalyticRate &rate)
+{
+  if (rate.family == RATE_DSSS)
+  {
+    return {RATE_DSSS, rate.rate >= 2 ? 2.0 : 1.0, 0};
+  }
+  return {RATE_OFDM, rate.rate >= 24 ? 24.0 : rate.rate >= 12 ? 12.0 : 6.0, 0};
+}
+
+// The flow of one STA in one direction
+struct AnalyticFlow
+{
+  bool downlink;
+  uint32_t sta;
+  bool reachable;      // the STA can associate
+  bool decodable;      // its frames get through at the rate used
+  double rss;          // dBm
+  double offered;      // kbps
+  AnalyticRate rate;
+  uint32_t mpdus;      // MPDUs in a PPDU
+  double success;      // s, one PPDU and its acknowledgement, deferral included
+};
+
+//------------------------------------------------------------
+//-- WifiAnalyticModel
+//------------------------------------------------------------
+
+double WifiAnalyticModel::GetFrequency(const std::string &standard)
+{
+  if (standard == "b" || standard == "g" || standard.find("24") != std::string::npos)
+  {
+    return 2.4e9;
+  }
+  return 5.15e9;
+}
+
+double WifiAnalyticModel::GetReferenceLoss(double frequency)
+{
+  double c = 3e8; // Speed of light
+  return 20 * log10(frequency) + 20 * log10(4 * M_PI / c);
+}
+
+void WifiAnalyticModel::SolveBianchi(uint32_t n, uint32_t cwMin, uint32_t cwMax, double &tau, double &p)
+{
+  double w = cwMin + 1;
+  uint32_t stages = 0;
+  while ((cwMin + 1) << stages < cwMax + 1)
+  {
+    stages++;
+  }
+  // tau = 2 (1 - 2p) / ((1 - 2p)(W + 1) + pW (1 - (2p)^m)), with the (1 - 2p) divided out
+  auto getTau = [&](double p) {
+    double sum = 0.0;
+    for (uint32_t k = 0; k < stages; ++k)
+    {
+      sum += std::pow(2 * p, k);
+    }
+    return 2.0 / (1.0 + w + p * w * sum);
+  };
+  if (n <= 1)
+  {
+    p = 0.0;
+    tau = getTau(0.0);
+    return;
+  }
+  // p - (1 - (1 - tau(p))^(n - 1)) goes from negative to positive over [0, 1)
+  double low = 0.0;
+  double high = 1.0;
+  for (uint32_t i = 0; i < 60; ++i)
+  {
+    p = (low + high) / 2;
+    if (p - (1.0 - std::pow(1.0 - getTau(p), n - 1)) < 0)
+    {
+      low = p;
+    }
+    else
+    {
+      high = p;
+    }
+  }
+  tau = getTau(p);
+}
+
+WifiAnalyticEstimate WifiAnalyticModel::Estimate(const WifiScenarioConfig &config)
+{
+  WifiAnalyticEstimate estimate;
+  std::vector<AnalyticRate> rates = GetRates(config);
+  if (rates.empty() || config.staNum == 0)
+  {
+    return estimate;
+  }
+  bool legacy = config.standard == "a" || config.standard == "b" || config.standard == "g";
+  bool aggregation = rates[0].family != RATE_DSSS && rates[0].family != RATE_OFDM;
+
+  // MAC timing, DCF for the legacy standards and EDCA best effort for the others
+  double frequency = GetFrequency(config.standard);
+  double slot = config.standard == "b" ? 20e-6 : 9e-6;
+  double sifs = frequency < 3e9 ? 10e-6 : 16e-6;
+  double aifs = sifs + (legacy ? 2 : 3) * slot;
+  uint32_t cwMin = config.standard == "b" ? 31 : 15;
+  uint32_t cwMax = 1023;
+
+  // RSS of every STA from the log-distance model, the same placement as the simulation
+  double txPower = config.TxPowerLevels > 1 ? config.TxPowerStart : config.TxPowerEnd;
+  if (txPower == -100)
+  {
+    txPower = 16.0206; // the YansWifiPhy default
+  }
+  double refLoss = GetReferenceLoss(frequency);
+  double noise = -174 + 10 * log10((rates[0].family == RATE_DSSS ? 22 : config.channelWidth) * 1e6) + NOISE_FIGURE;
+  std::vector<double> staDistances(config.staNum, config.distance);
+  std::vector<uint32_t> staAps(config.staNum, 0);
+  if (config.layout != "")
+  {
+    WifiTopology topology;
+    if (!WifiTopologyGenerator::Generate(GetTopologyConfig(config), topology))
+    {
+      return estimate;
+    }
+    for (uint32_t i = 0; i < config.staNum; ++i)
+    {
+      Vector sta = topology.staPositions[i];
+      Vector ap = topology.apPositions[topology.staAps[i]];
+      staDistances[i] = std::sqrt((sta.x - ap.x) * (sta.x - ap.x) + (sta.y - ap.y) * (sta.y - ap.y));
+      staAps[i] = topology.staAps[i];
+    }
+  }
+  else if (config.distancesStr != "")
+  {
+    // The i-th distance is the one of the i-th STA, the others are at the default distance
+    std::stringstream ss(config.distancesStr);
+    std::string item;
+    for (uint32_t i = 0; i < config.staNum && std::getline(ss, item, ','); ++i)
+    {
+      staDistances[i] = std::atof(item.c_str());
+    }
+  }
+
+  // Offered load of every flow, a flow sends at most packetNum packets
+  bool saturated = config.trafficModel == "saturated";
+  double offered = std::min((double)config.desiredDataRate,
+                            (double)config.packetNum * config.packetSize * 8 / config.duration / 1000);
+  bool downlink = config.direction != "uplink";
+  bool uplink = config.direction != "downlink";
+
+  // MPDU: app payload, UDP, IP, LLC/SNAP, MAC header and FCS, and its A-MPDU subframe
+  double mpduSize = config.packetSize + 8 + 20 + 8 + (legacy ? 24 : 26) + 4;
+  double subframeSize = std::ceil((mpduSize + 4) / 4) * 4;
+
+  std::vector<AnalyticFlow> flows;
+  std::vector<uint32_t> apFlows(config.apNum, 0);
+  estimate.linkMargin = std::numeric_limits<double>::infinity();
+  for (uint32_t i = 0; i < config.staNum; ++i)
+  {
+    double d = staDistances[i];
+    double rss = txPower - refLoss - (d > 1 ? 10 * config.lossExp * log10(d) : 0);
+    double snr = rss - noise;
+    // Associating takes the beacons at the slowest rate
+    double margin = std::min(rss - RX_SENSITIVITY, snr - (rates[0].family == RATE_DSSS ? DSSS_SNR[0] : OFDM_SNR[0]));
+    estimate.linkMargin = std::min(estimate.linkMargin, margin);
+    bool reachable = margin >= 0;
+    if (!reachable)
+    {
+      estimate.unreachable++;
+    }
+
+    // Rate control settles on the fastest rate the SNR allows, a constant rate may be too fast
+    AnalyticRate rate = rates[0];
+    bool decodable = snr >= rate.snr;
+    for (const AnalyticRate &r : rates)
+    {
+      if (snr >= r.snr)
+      {
+        rate = r;
+      }
+    }
+
+    for (uint32_t dir = 0; dir < 2; ++dir)
+    {
+      if (!(dir == 0 ? downlink : uplink))
+      {
+        continue;
+      }
+      AnalyticFlow flow;
+      flow.downlink = dir == 0;
+      flow.sta = i;
+      flow.reachable = reachable;
+      flow.decodable = reachable && decodable;
+      flow.rss = rss;
+      flow.offered = offered;
+      flow.rate = rate;
+      flow.mpdus = 1;
+      if (aggregation)
+      {
+        uint32_t limit = std::min<uint32_t>(BLOCK_ACK_WINDOW, MAX_AMPDU_SIZE / subframeSize);
+        while (limit > 1 && GetPpduDuration(rate, limit * subframeSize) > MAX_PPDU_DURATION)
+        {
+          limit--;
+        }
+        flow.mpdus = std::max<uint32_t>(1, limit);
+      }
+      if (flow.reachable && flow.downlink)
+      {
+        apFlows[staAps[i]]++;
+      }
+      flows.push_back(flow);
+    }
+  }
+
+  // The AP's queue is shared by its flows, so are the MPDUs it can aggregate for one STA.
+  // An A-MPDU is acknowledged by a compressed BlockAck, a single MPDU by an ACK.
+  std::set<uint32_t> senders;
+  for (AnalyticFlow &flow : flows)
+  {
+    if (!flow.reachable)
+    {
+      continue;
+    }
+    if (flow.downlink)
+    {
+      flow.mpdus = std::max<uint32_t>(1, std::min<uint32_t>(flow.mpdus, QUEUE_SIZE / apFlows[staAps[flow.sta]]));
+      senders.insert(staAps[flow.sta]);
+    }
+    else
+    {
+      senders.insert(config.apNum + flow.sta);
+    }
+    double ppdu = GetPpduDuration(flow.rate, flow.mpdus > 1 ? flow.mpdus * subframeSize : mpduSize);
+    double response = GetPpduDuration(GetControlRate(flow.rate), flow.mpdus > 1 ? 32 : 14);
+    flow.success = aifs + ppdu + sifs + response;
+  }
+
+  // Bianchi: a slot is idle, a success or a collision. The PPDUs are the ones of the flows, one flow's
+  // share of them is its share of the packets over its MPDUs per PPDU. The frames of a flow whose rate
+  // is too fast are sent until the retry limit and are never received.
+  double served = 0.0; // offered bits a second served from the queues
+  if (!senders.empty())
+  {
+    double tau, p;
+    uint32_t n = senders.size();
+    SolveBianchi(n, cwMin, cwMax, tau, p);
+    double ptr = 1.0 - std::pow(1.0 - tau, n);
+    double ps = n * tau * std::pow(1.0 - tau, n - 1) / ptr;
+
+    double weights = 0.0;
+    for (const AnalyticFlow &flow : flows)
+    {
+      if (flow.reachable)
+      {
+        weights += 1.0 / flow.mpdus;
+      }
+    }
+    double ts = 0.0;
+    double tc = 0.0;
+    double bits = 0.0;
+    for (const AnalyticFlow &flow : flows)
+    {
+      if (flow.reachable)
+      {
+        double share = 1.0 / flow.mpdus / weights;
+        ts += share * flow.success * (flow.decodable ? 1 : RETRY_LIMIT);
+        tc += share * flow.success;
+        bits += share * flow.mpdus * config.packetSize * 8;
+      }
+    }
+    served = ps * ptr * bits / ((1.0 - ptr) * slot + ptr * ps * ts + ptr * (1.0 - ps) * tc);
+
+    // Beacons of every AP at the slowest rate
+    AnalyticRate beaconRate = frequency < 3e9 ? AnalyticRate{RATE_DSSS, 1, 0} : AnalyticRate{RATE_OFDM, 6, 0};
+    double beacons = config.apNum * (aifs + GetPpduDuration(beaconRate, BEACON_SIZE)) /
+                     (config.fastAssociation ? 0.1024 : 1.024);
+    served *= std::max(0.0, 1.0 - beacons);
+  }
+  estimate.capacity = served / 1000;
+
+  double demand = 0.0;
+  for (const AnalyticFlow &flow : flows)
+  {
+    if (flow.reachable)
+    {
+      demand += flow.offered;
+    }
+  }
+  estimate.load = saturated ? std::numeric_limits<double>::infinity() : estimate.capacity > 0 ? demand / estimate.capacity : 0.0;
+
+  // Below capacity every flow gets what it offers, above it every flow gets the same fraction of it.
+  // Saturated flows offer what they get.
+  uint32_t reachableFlows = 0;
+  for (const AnalyticFlow &flow : flows)
+  {
+    reachableFlows += flow.reachable ? 1 : 0;
+  }
+  for (uint32_t dir = 0; dir < 2; ++dir)
+  {
+    WifiDirectionEstimate &result = dir == 0 ? estimate.downlink : estimate.uplink;
+    result.active = dir == 0 ? downlink : uplink;
+    if (!result.active)
+    {
+      continue;
+    }
+    double rssSum = 0.0;
+    double rssWeight = 0.0;
+    for (const AnalyticFlow &flow : flows)
+    {
+      if (flow.downlink != (dir == 0))
+      {
+        continue;
+      }
+      double tx = flow.offered;
+      double rx = flow.reachable ? tx / std::max(1.0, estimate.load) : 0.0;
+      if (saturated)
+      {
+        tx = rx = flow.reachable ? estimate.capacity / reachableFlows : 0.0;
+      }
+      if (!flow.decodable)
+      {
+        rx = 0.0;
+      }
+      result.appDataTXRate += tx;
+      result.appDataRXRate += rx;
+      // The RSS is averaged over the frames received, links are symmetric
+      if (flow.reachable)
+      {
+        rssSum += flow.rss * std::max(rx, 1e-9);
+        rssWeight += std::max(rx, 1e-9);
+      }
+    }
+    result.appDataLossRatio = result.appDataTXRate > 0 ? 1.0 - result.appDataRXRate / result.appDataTXRate : 1.0;
+    result.avgRSS = rssWeight > 0 ? rssSum / rssWeight : std::numeric_limits<double>::quiet_NaN();
+  }
+  estimate.valid = true;
+  return estimate;
+}
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_ANALYTIC_H
+#define EE500_WIFI_ANALYTIC_H
+
+#include <cstdint>
+#include <string>
+
+struct WifiScenarioConfig;
+
+// Predicted metrics of the flows in one direction, the same units as WifiDirectionResults
+struct WifiDirectionEstimate
+{
+  bool active = false;
+  double appDataTXRate = 0.0;    // kbps
+  double appDataRXRate = 0.0;    // kbps
+  double appDataLossRatio = 0.0;
+  double avgRSS = 0.0;           // dBm of the frames received, NaN if none are
+};
+
+// What the analytical model predicts for a scenario
+struct WifiAnalyticEstimate
+{
+  bool valid = false;            // false if the configuration can't be modelled
+  double load = 0.0;             // offered traffic over the capacity, infinite when saturated
+  double capacity = 0.0;         // kbps of app data the channel carries with the flows' mix of rates
+  double linkMargin = 0.0;       // dB, smallest margin of a STA's RSS over what it needs to stay associated
+  uint32_t unreachable = 0;      // STAs below that
+
+  WifiDirectionEstimate downlink;
+  WifiDirectionEstimate uplink;
+};
+
+// Analytical estimate of a scenario in microseconds instead of a simulation.
+// Every STA's RSS comes from the same log-distance model as the simulation, its SNR picks the
+// rate (the highest one it can decode with minstrel, the given one with a constant rate).
+// The channel capacity is Bianchi's saturation throughput of the DCF (EDCA best effort from 802.11n on)
+// with as many contenders as there are senders, every PPDU carrying the A-MPDU the queues allow.
+// Every AP and STA is assumed to hear all the others, the flows get the same share of the packets
+// and the losses come from saturation and from links too weak for their rate only.
+class WifiAnalyticModel
+{
+public:
+  static WifiAnalyticEstimate Estimate(const WifiScenarioConfig &config);
+
+  // Carrier frequency of the standard in Hz, 2.4 or 5.15 GHz
+  static double GetFrequency(const std::string &standard);
+  // Free space loss at 1 meter in dB, the reference loss of the log-distance model
+  static double GetReferenceLoss(double frequency);
+
+  // Bianchi's fixed point for n saturated stations: the probability tau that a station transmits
+  // in a slot and the probability p that its transmission collides
+  static void SolveBianchi(uint32_t n, uint32_t cwMin, uint32_t cwMax, double &tau, double &p);
+};
+
+#endif /* EE500_WIFI_ANALYTIC_H */
@@ -17,6 +17,7 @@
  * Modified by: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
  */
 
+#include <algorithm>
 #include <ostream>
 
 #include "ee500_wifi_app.h"
@@ -55,13 +56,36 @@ Sender::GetTypeId(void)
                                         StringValue("ns3::ConstantRandomVariable[Constant=0.5]"),
                                         MakePointerAccessor(&Sender::m_interval),
                                         MakePointerChecker<RandomVariableStream>())
+                          .AddAttribute("PacketSizes", "Sizes of the packets, PacketSize is used if not set.",
+                                        PointerValue(),
+                                        MakePointerAccessor(&Sender::m_pktSizes),
+                                        MakePointerChecker<RandomVariableStream>())
+                          .AddAttribute("OnTime", "Length of the on periods, always on if not set.",
+                                        PointerValue(),
+                                        MakePointerAccessor(&Sender::m_onTime),
+                                        MakePointerChecker<RandomVariableStream>())
+                          .AddAttribute("OffTime", "Length of the off periods between the on periods.",
+                                        StringValue("ns3::ConstantRandomVariable[Constant=1.0]"),
+                                        MakePointerAccessor(&Sender::m_offTime),
+                                        MakePointerChecker<RandomVariableStream>())
+                          .AddAttribute("Saturated", "Keep the MAC queue filled instead of sending at Interval.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&Sender::m_saturated),
+                                        MakeBooleanChecker())
+                          .AddAttribute("SaturationWindow", "Number of packets kept in the MAC queue in the saturated mode.",
+                                        UintegerValue(64),
+                                        MakeUintegerAccessor(&Sender::m_window),
+                                        MakeUintegerChecker<uint32_t>(1))
                           .AddTraceSource("Tx", "A new packet is created and is sent",
                                           MakeTraceSourceAccessor(&Sender::m_txTrace),
                                           "ns3::Packet::TracedCallback");
   return tid;
 }
 
-Sender::Sender() : m_calc(0)
+Sender::Sender() : m_isIntervalConstant(false),
+                   m_queued(0),
+                   m_running(false),
+                   m_calc(0)
 {
   NS_LOG_FUNCTION_NOARGS();
   m_interval = CreateObject<ConstantRandomVariable>();
@@ -91,43 +115,79 @@ void Sender::StartApplication()
     Ptr<SocketFactory> socketFactory = GetNode()->GetObject<SocketFactory>(UdpSocketFactory::GetTypeId());
     m_socket = socketFactory->CreateSocket();
     m_socket->Bind();
+    // The destination never changes, so the socket is connected once and every packet goes out with Send()
+    m_socket->Connect(InetSocketAddress(m_destAddr, m_destPort));
+  }
+
+  // A constant interval is converted to a Time once instead of once per packet
+  Ptr<ConstantRandomVariable> constantInterval = DynamicCast<ConstantRandomVariable>(m_interval);
+  m_isIntervalConstant = constantInterval != 0;
+  if (m_isIntervalConstant)
+  {
+    m_constantInterval = Seconds(constantInterval->GetValue());
   }
 
   m_count = 0;
+  if (m_onTime != 0)
+  {
+    m_onEnd = Simulator::Now() + Seconds(m_onTime->GetValue());
+  }
 
   Simulator::Cancel(m_sendEvent);
-  m_sendEvent = Simulator::ScheduleNow(&Sender::SendPacket, this);
+  Simulator::Cancel(m_refillEvent);
+  m_running = true;
+  if (m_saturated)
+  {
+    m_refillEvent = Simulator::ScheduleNow(&Sender::Refill, this);
+  }
+  else
+  {
+    m_sendEvent = Simulator::ScheduleNow(&Sender::SendPacket, this);
+  }
 }
 
 void Sender::StopApplication()
 {
   NS_LOG_FUNCTION_NOARGS();
+  m_running = false;
   Simulator::Cancel(m_sendEvent);
+  Simulator::Cancel(m_refillEvent);
 }
 
 void Sender::SendPacket()
+{
+  TransmitPacket();
+
+  if (m_count < m_numPkts)
+  {
+    ScheduleNextPacket();
+  }
+}
+
+void Sender::TransmitPacket()
 {
   // NS_LOG_FUNCTION_NOARGS ();
   NS_LOG_INFO("Sending packet at " << Simulator::Now() << " to " << m_destAddr);
 
-  Ptr<Packet> packet = Create<Packet>(m_pktSize);
+  uint32_t size = m_pktSize;
+  if (m_pktSizes != 0)
+  {
+    size = std::max<uint32_t>(m_pktSizes->GetInteger(), 1);
+  }
+  // Every packet needs its own Packet object, the lower layers add their headers to it
+  // and the MAC queue keeps it, and a copy of a template packet would share its UID.
+  Ptr<Packet> packet = Create<Packet>(size);
 
   TimestampTag timestamp;
   timestamp.SetTimestamp(Simulator::Now());
+  timestamp.SetSequence(m_count);
   packet->AddByteTag(timestamp);
 
-  // Could connect the socket since the address never changes; using SendTo
-  // here simply because all of the standard apps do not.
-  m_socket->SendTo(packet, 0, InetSocketAddress(m_destAddr, m_destPort));
+  m_socket->Send(packet);
 
   // Report the event to the trace.
   m_txTrace(packet);
-
-  if (++m_count < m_numPkts)
-  {
-    m_sendEvent = Simulator::Schedule(Seconds(m_interval->GetValue()),
-                                      &Sender::SendPacket, this);
-  }
+  m_count++;
 
   // Update the counter.
   if (m_calc != 0)
@@ -136,6 +196,65 @@ void Sender::SendPacket()
   }
 }
 
+void Sender::Refill()
+{
+  while (m_queued < m_window && m_count < m_numPkts)
+  {
+    uint32_t queued = m_queued;
+    TransmitPacket();
+    if (m_queued == queued)
+    {
+      // The packet didn't reach the MAC queue right away (e.g. it waits for ARP),
+      // the next packet goes out when the queue moves again
+      break;
+    }
+  }
+
+  if (m_queued == 0 && m_count < m_numPkts)
+  {
+    // Nothing of this flow is queued, so no dequeue will come if the packet is lost on its way
+    // (e.g. ARP gives up), try again later
+    m_refillEvent = Simulator::Schedule(MilliSeconds(100), &Sender::Refill, this);
+  }
+}
+
+void Sender::NotifyMacEnqueue(void)
+{
+  m_queued++;
+}
+
+void Sender::NotifyMacDequeue(void)
+{
+  if (m_queued > 0)
+  {
+    m_queued--;
+  }
+  if (!m_running)
+  {
+    return;
+  }
+  // The MAC is in the middle of dequeuing, the queue is refilled right after it.
+  // An A-MPDU dequeues several packets at once, they are refilled in one go.
+  if (!m_refillEvent.IsRunning() || m_refillEvent.GetTs() != static_cast<uint64_t>(Simulator::Now().GetTimeStep()))
+  {
+    Simulator::Cancel(m_refillEvent);
+    m_refillEvent = Simulator::ScheduleNow(&Sender::Refill, this);
+  }
+}
+
+void Sender::ScheduleNextPacket()
+{
+  Time delay = m_isIntervalConstant ? m_constantInterval : Seconds(m_interval->GetValue());
+  if (m_onTime != 0 && Simulator::Now() + delay > m_onEnd)
+  {
+    // The on period is over before the next packet, it goes out at the start of the next on period
+    Time next = m_onEnd + Seconds(m_offTime->GetValue());
+    m_onEnd = next + Seconds(m_onTime->GetValue());
+    delay = next - Simulator::Now();
+  }
+  m_sendEvent = Simulator::Schedule(delay, &Sender::SendPacket, this);
+}
+
 void Sender::SetCounter(Ptr<CounterCalculator<>> calc)
 {
   m_calc = calc;
@@ -162,7 +281,9 @@ Receiver::GetTypeId(void)
 }
 
 Receiver::Receiver() : m_calc(0),
-                       m_delay(0)
+                       m_delay(0),
+                       m_quantiles(0),
+                       m_flow(0)
 {
   NS_LOG_FUNCTION_NOARGS();
   m_socket = 0;
@@ -218,6 +339,21 @@ void Receiver::SetDelayTracker(Ptr<TimeMinMaxAvgTotalCalculator> delay)
   m_delay = delay;
 }
 
+void Receiver::SetDelayQuantiles(Ptr<DelayQuantileCalculator> quantiles)
+{
+  m_quantiles = quantiles;
+}
+
+void Receiver::SetFlowStats(Ptr<FlowStatsCalculator> flow)
+{
+  m_flow = flow;
+}
+
+Time Receiver::GetDelaySum(void) const
+{
+  return m_delaySum;
+}
+
 void Receiver::Receive(Ptr<Socket> socket)
 {
   // NS_LOG_FUNCTION (this << socket << packet << from);
@@ -237,10 +373,22 @@ void Receiver::Receive(Ptr<Socket> socket)
     if (packet->FindFirstMatchingByteTag(timestamp))
     {
       Time tx = timestamp.GetTimestamp();
+      Time delay = Simulator::Now() - tx;
+      m_delaySum += delay;
 
       if (m_delay != 0)
       {
-        m_delay->Update(Simulator::Now() - tx);
+        m_delay->Update(delay);
+      }
+
+      if (m_quantiles != 0)
+      {
+        m_quantiles->Update(delay);
+      }
+
+      if (m_flow != 0)
+      {
+        m_flow->Update(timestamp.GetSequence(), delay);
       }
     }
 
@@ -268,7 +416,12 @@ TimestampTag::GetTypeId(void)
                                         "Some momentous point in time!",
                                         EmptyAttributeValue(),
                                         MakeTimeAccessor(&TimestampTag::GetTimestamp),
-                                        MakeTimeChecker());
+                                        MakeTimeChecker())
+                          .AddAttribute("Sequence",
+                                        "Index of the packet in its flow.",
+                                        EmptyAttributeValue(),
+                                        MakeUintegerAccessor(&TimestampTag::GetSequence),
+                                        MakeUintegerChecker<uint32_t>());
   return tid;
 }
 TypeId
@@ -276,22 +429,27 @@ TimestampTag::GetInstanceTypeId(void) const
 {
   return GetTypeId();
 }
+TimestampTag::TimestampTag() : m_sequence(0)
+{
+}
 
 uint32_t
 TimestampTag::GetSerializedSize(void) const
 {
-  return 8;
+  return 12;
 }
 void TimestampTag::Serialize(TagBuffer i) const
 {
   int64_t t = m_timestamp.GetNanoSeconds();
   i.Write((const uint8_t *)&t, 8);
+  i.WriteU32(m_sequence);
 }
 void TimestampTag::Deserialize(TagBuffer i)
 {
   int64_t t;
   i.Read((uint8_t *)&t, 8);
   m_timestamp = NanoSeconds(t);
+  m_sequence = i.ReadU32();
 }
 
 void TimestampTag::SetTimestamp(Time time)
@@ -303,7 +461,16 @@ Time TimestampTag::GetTimestamp(void) const
   return m_timestamp;
 }
 
+void TimestampTag::SetSequence(uint32_t sequence)
+{
+  m_sequence = sequence;
+}
+uint32_t TimestampTag::GetSequence(void) const
+{
+  return m_sequence;
+}
+
 void TimestampTag::Print(std::ostream &os) const
 {
-  os << "t=" << m_timestamp;
+  os << "seq=" << m_sequence << " t=" << m_timestamp;
 }
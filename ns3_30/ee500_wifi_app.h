@@ -17,12 +17,18 @@
  * Modified by: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
  */
 
+#ifndef EE500_WIFI_APP_H
+#define EE500_WIFI_APP_H
+
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/application.h"
 #include "ns3/stats-module.h"
 
+#include "ee500_wifi_flow.h"
+#include "ee500_wifi_sketch.h"
+
 using namespace ns3;
 
 class Sender : public Application
@@ -33,6 +39,11 @@ public:
   virtual ~Sender();
   void SetCounter(Ptr<CounterCalculator<>> calc);
 
+  // In the saturated mode the MAC queue the packets go through reports every packet
+  // of this flow entering and leaving it, the Sender keeps SaturationWindow of them queued
+  void NotifyMacEnqueue(void);
+  void NotifyMacDequeue(void);
+
 protected:
   virtual void DoDispose(void);
 
@@ -41,15 +52,29 @@ private:
   virtual void StopApplication(void);
 
   void SendPacket();
+  void ScheduleNextPacket();
+  void TransmitPacket();
+  void Refill();
 
   uint32_t m_pktSize;
+  Ptr<RandomVariableStream> m_pktSizes;
   Ipv4Address m_destAddr;
   uint32_t m_destPort;
-  Ptr<ConstantRandomVariable> m_interval;
+  Ptr<RandomVariableStream> m_interval;
+  bool m_isIntervalConstant;
+  Time m_constantInterval;
+  Ptr<RandomVariableStream> m_onTime;
+  Ptr<RandomVariableStream> m_offTime;
+  Time m_onEnd;
   uint32_t m_numPkts;
+  bool m_saturated;
+  uint32_t m_window;
+  uint32_t m_queued;
+  bool m_running;
 
   Ptr<Socket> m_socket;
   EventId m_sendEvent;
+  EventId m_refillEvent;
 
   TracedCallback<Ptr<const Packet>> m_txTrace;
 
@@ -66,6 +91,11 @@ public:
 
   void SetCounter(Ptr<CounterCalculator<>> calc);
   void SetDelayTracker(Ptr<TimeMinMaxAvgTotalCalculator> delay);
+  void SetDelayQuantiles(Ptr<DelayQuantileCalculator> quantiles);
+  void SetFlowStats(Ptr<FlowStatsCalculator> flow);
+
+  // Sum of the delays of all packets received so far
+  Time GetDelaySum(void) const;
 
 protected:
   virtual void DoDispose(void);
@@ -84,13 +114,18 @@ private:
 
   Ptr<CounterCalculator<>> m_calc;
   Ptr<TimeMinMaxAvgTotalCalculator> m_delay;
+  Ptr<DelayQuantileCalculator> m_quantiles;
+  Ptr<FlowStatsCalculator> m_flow;
+  Time m_delaySum;
 };
 
+// Sequence number and send time of a packet, the sequence is the index of the packet in its flow
 class TimestampTag : public Tag
 {
 public:
   static TypeId GetTypeId(void);
   virtual TypeId GetInstanceTypeId(void) const;
+  TimestampTag();
 
   virtual uint32_t GetSerializedSize(void) const;
   virtual void Serialize(TagBuffer i) const;
@@ -99,9 +134,14 @@ public:
   // these are our accessors to our tag structure
   void SetTimestamp(Time time);
   Time GetTimestamp(void) const;
+  void SetSequence(uint32_t sequence);
+  uint32_t GetSequence(void) const;
 
   void Print(std::ostream &os) const;
 
 private:
   Time m_timestamp;
+  uint32_t m_sequence;
 };
+
+#endif /* EE500_WIFI_APP_H */
@@ -0,0 +1,361 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/wifi-module.h"
+
+#include "ee500_wifi_app.h"
+#include "ee500_wifi_bench.h"
+#include "ee500_wifi_scenario.h"
+#include "ee500_wifi_stats.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("WifiBench");
+
+//------------------------------------------------------------
+//-- Reference implementation of the PHY trace callbacks
+//------------------------------------------------------------
+
+// The way MonitorSniffRxCallback inspected single MPDUs before: copy the packet,
+// remove the header from the copy and look the AP address up through the NodeList.
+// It counts into the same per-STA counters, so only the header inspection is compared.
+static void CopyingSniffRx(Mac48Address mac, StaPhyCounters *counters,
+                           Ptr<const Packet> packet, SignalNoiseDbm signalNoise)
+{
+  Ptr<Packet> pktCopy = packet->Copy();
+  WifiMacHeader macHeader;
+  pktCopy->RemoveHeader(macHeader);
+
+  // Assuming AP is the first created device (Node 0, Device 0)
+  Mac48Address apMac = Mac48Address::ConvertFrom(NodeList::GetNode(0)->GetDevice(0)->GetAddress());
+
+  if (macHeader.IsData() && macHeader.GetAddr3() == apMac && mac == macHeader.GetAddr1())
+  {
+    counters->rxCount++;
+    counters->rxBytes += pktCopy->GetSize();
+    counters->rssSum += signalNoise.signal;
+  }
+}
+
+//------------------------------------------------------------
+//-- Reference implementation of the Sender send path
+//------------------------------------------------------------
+
+// The way Sender sent its packets before: a fresh InetSocketAddress and SendTo() for every
+// packet on an unconnected socket, and the interval drawn and converted to a Time every time.
+class ReferenceSender : public Application
+{
+public:
+  static TypeId GetTypeId(void)
+  {
+    static TypeId tid = TypeId("ReferenceSender")
+                            .SetParent<Application>()
+                            .AddConstructor<ReferenceSender>();
+    return tid;
+  }
+
+  void Setup(Ipv4Address destAddr, uint16_t destPort, uint32_t pktSize, uint32_t numPkts, double interval)
+  {
+    m_destAddr = destAddr;
+    m_destPort = destPort;
+    m_pktSize = pktSize;
+    m_numPkts = numPkts;
+    m_interval = CreateObject<ConstantRandomVariable>();
+    m_interval->SetAttribute("Constant", DoubleValue(interval));
+  }
+
+protected:
+  virtual void DoDispose(void)
+  {
+    m_socket = 0;
+    Application::DoDispose();
+  }
+
+private:
+  virtual void StartApplication(void)
+  {
+    m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    m_socket->Bind();
+    m_count = 0;
+    Simulator::ScheduleNow(&ReferenceSender::SendPacket, this);
+  }
+
+  virtual void StopApplication(void)
+  {
+  }
+
+  void SendPacket()
+  {
+    Ptr<Packet> packet = Create<Packet>(m_pktSize);
+    TimestampTag timestamp;
+    timestamp.SetTimestamp(Simulator::Now());
+    timestamp.SetSequence(m_count);
+    packet->AddByteTag(timestamp);
+    m_socket->SendTo(packet, 0, InetSocketAddress(m_destAddr, m_destPort));
+    if (++m_count < m_numPkts)
+    {
+      Simulator::Schedule(Seconds(m_interval->GetValue()), &ReferenceSender::SendPacket, this);
+    }
+  }
+
+  Ptr<Socket> m_socket;
+  Ipv4Address m_destAddr;
+  uint16_t m_destPort;
+  uint32_t m_pktSize;
+  uint32_t m_numPkts;
+  uint32_t m_count;
+  Ptr<ConstantRandomVariable> m_interval;
+};
+
+//------------------------------------------------------------
+//-- Benchmarks
+//------------------------------------------------------------
+
+static double ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+void RunCallbackBenchmark(uint32_t frames)
+{
+  // The reference callback needs the AP as device 0 of node 0
+  NodeContainer nodes;
+  nodes.Create(2);
+  Ptr<SimpleNetDevice> apDevice = CreateObject<SimpleNetDevice>();
+  Ptr<SimpleNetDevice> staDevice = CreateObject<SimpleNetDevice>();
+  apDevice->SetAddress(Mac48Address::Allocate());
+  staDevice->SetAddress(Mac48Address::Allocate());
+  nodes.Get(0)->AddDevice(apDevice);
+  nodes.Get(1)->AddDevice(staDevice);
+  Mac48Address apMac = Mac48Address::ConvertFrom(apDevice->GetAddress());
+  Mac48Address staMac = Mac48Address::ConvertFrom(staDevice->GetAddress());
+  Mac48Address otherMac = Mac48Address::Allocate();
+
+  // With N STAs a STA overhears N-1 frames for other STAs for every frame of its own,
+  // so the mix is one frame for this STA and three for another one.
+  std::vector<Ptr<const Packet>> packets;
+  for (uint32_t i = 0; i < 4; ++i)
+  {
+    WifiMacHeader macHeader;
+    macHeader.SetType(WIFI_MAC_DATA);
+    macHeader.SetDsFrom();
+    macHeader.SetDsNotTo();
+    macHeader.SetAddr1(i == 0 ? staMac : otherMac);
+    macHeader.SetAddr2(apMac);
+    macHeader.SetAddr3(apMac);
+    Ptr<Packet> packet = Create<Packet>(1028); // 1000 bytes of payload + UDP and IP headers
+    packet->AddHeader(macHeader);
+    packets.push_back(packet);
+  }
+
+  WifiTxVector txVector;
+  MpduInfo aMpdu;
+  aMpdu.type = NORMAL_MPDU;
+  aMpdu.mpduRefNumber = 0;
+  SignalNoiseDbm signalNoise;
+  signalNoise.signal = -60.0;
+  signalNoise.noise = -94.0;
+
+  StaPhyCounters copyingStats;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < frames; ++i)
+  {
+    CopyingSniffRx(staMac, &copyingStats, packets[i & 3], signalNoise);
+  }
+  double copyingNs = ElapsedNs(start);
+
+  Ptr<WifiPhyStats> peekingStats = CreateObject<WifiPhyStats>();
+  peekingStats->SetStaNum(1);
+  StaTraceContext context;
+  context.staMac = staMac;
+  context.apMac = apMac;
+  context.staIndex = 0;
+  context.phyStats = PeekPointer(peekingStats);
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < frames; ++i)
+  {
+    MonitorSniffRxCallback(&context, packets[i & 3], 5180, txVector, aMpdu, signalNoise);
+  }
+  double peekingNs = ElapsedNs(start);
+
+  const StaPhyCounters &peekingCounters = peekingStats->GetCounters(0);
+  if (copyingStats.rxCount != peekingCounters.rxCount || copyingStats.rxBytes != peekingCounters.rxBytes)
+  {
+    std::cout << "Callback results differ: " << copyingStats.rxCount << " vs "
+              << peekingCounters.rxCount << " MPDUs" << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(60) << "Callback (" + std::to_string(frames) + " frames)" << std::setw(20) << "ns/frame" << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+  std::cout << std::setw(60) << "MonitorSniffRx, copy + RemoveHeader + NodeList lookup:" << std::setw(20) << copyingNs / frames << std::endl;
+  std::cout << std::setw(60) << "MonitorSniffRx, PeekHeader + bound AP address:" << std::setw(20) << peekingNs / frames << std::endl;
+
+  Simulator::Destroy();
+}
+
+// Runs the given sender on node 0 of a two-node network of SimpleNetDevices until it has sent
+// all its packets, returns the wall time in ns. The packets go through UDP, IP and ARP down to
+// the device; node 1 has a bound socket nobody reads, so the receiving side costs as little as it can.
+static double RunSendVariant(bool reference, uint32_t packets)
+{
+  Ipv4AddressGenerator::Reset();
+
+  NodeContainer nodes;
+  nodes.Create(2);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install(nodes);
+  InternetStackHelper stack;
+  stack.Install(nodes);
+  Ipv4AddressHelper address;
+  address.SetBase("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer ifaces = address.Assign(devices);
+
+  const uint16_t port = 1000;
+  Ptr<Socket> sink = Socket::CreateSocket(nodes.Get(1), UdpSocketFactory::GetTypeId());
+  sink->Bind(InetSocketAddress(Ipv4Address::GetAny(), port));
+
+  // 1000 bytes every microsecond, far more than any STA is offered
+  const double interval = 1e-6;
+  if (reference)
+  {
+    Ptr<ReferenceSender> sender = CreateObject<ReferenceSender>();
+    sender->Setup(ifaces.GetAddress(1), port, 1000, packets, interval);
+    nodes.Get(0)->AddApplication(sender);
+  }
+  else
+  {
+    Ptr<Sender> sender = CreateObject<Sender>();
+    sender->SetAttribute("Interval", StringValue("ns3::ConstantRandomVariable[Constant=" + std::to_string(interval) + "]"));
+    sender->SetAttribute("PacketSize", UintegerValue(1000));
+    sender->SetAttribute("NumPackets", UintegerValue(packets));
+    sender->SetAttribute("Destination", Ipv4AddressValue(ifaces.GetAddress(1)));
+    sender->SetAttribute("Port", UintegerValue(port));
+    nodes.Get(0)->AddApplication(sender);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Simulator::Run();
+  double elapsedNs = ElapsedNs(start);
+  Simulator::Destroy();
+  return elapsedNs;
+}
+
+void RunSendBenchmark(uint32_t packets)
+{
+  double referenceNs = RunSendVariant(true, packets);
+  double senderNs = RunSendVariant(false, packets);
+
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(40) << "Send path (" + std::to_string(packets) + " packets)"
+            << std::setw(20) << "ns/packet" << std::setw(20) << "packets/s" << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+  std::cout << std::setw(40) << "SendTo on an unconnected socket:" << std::setw(20) << referenceNs / packets
+            << std::setw(20) << packets / (referenceNs / 1e9) << std::endl;
+  std::cout << std::setw(40) << "Sender, connected socket:" << std::setw(20) << senderNs / packets
+            << std::setw(20) << packets / (senderNs / 1e9) << std::endl;
+}
+
+void RunSetupBenchmark()
+{
+  const std::vector<uint32_t> staNums = {1000, 2000, 5000, 10000};
+  std::vector<WifiRunProfile> profiles;
+  for (uint32_t staNum : staNums)
+  {
+    // Flows both ways, so every trace of the setup is connected
+    WifiScenarioConfig config;
+    config.staNum = staNum;
+    config.direction = "both";
+    config.strategy = "wifi-radial";
+    config.dbPrefix = "";
+    config.setupOnly = true;
+    WifiScenario scenario(config);
+    profiles.push_back(scenario.Run().profile);
+  }
+
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(20) << "Setup (STAs)" << std::setw(20) << "s"
+            << std::setw(20) << "us/STA" << std::setw(20) << "Growth" << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+  for (uint32_t i = 0; i < staNums.size(); ++i)
+  {
+    std::stringstream growth;
+    if (i > 0 && profiles[i - 1].setupTime > 0)
+    {
+      growth << std::log(profiles[i].setupTime / profiles[i - 1].setupTime) / std::log(static_cast<double>(staNums[i]) / staNums[i - 1]);
+    }
+    std::cout << std::setw(20) << staNums[i] << std::setw(20) << profiles[i].setupTime
+              << std::setw(20) << profiles[i].setupTime / staNums[i] * 1e6 << std::setw(20) << growth.str() << std::endl;
+  }
+
+  // The parts of the setup, one column per size
+  std::cout << std::endl;
+  std::cout << std::setw(16) << "Part (s)";
+  for (uint32_t staNum : staNums)
+  {
+    std::cout << std::setw(16) << staNum;
+  }
+  std::cout << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+  for (uint32_t p = 0; p < profiles[0].setupPhases.size(); ++p)
+  {
+    std::cout << std::setw(16) << profiles[0].setupPhases[p].first;
+    for (auto &profile : profiles)
+    {
+      std::cout << std::setw(16) << profile.setupPhases[p].second;
+    }
+    std::cout << std::endl;
+  }
+}
+
+bool RunBenchmark(const std::string &name, uint32_t iterations)
+{
+  if (name == "callbacks")
+  {
+    RunCallbackBenchmark(iterations);
+  }
+  else if (name == "send")
+  {
+    RunSendBenchmark(iterations);
+  }
+  else if (name == "setup")
+  {
+    RunSetupBenchmark();
+  }
+  else
+  {
+    std::cout << "Unknown benchmark: " << name << std::endl;
+    return false;
+  }
+  return true;
+}
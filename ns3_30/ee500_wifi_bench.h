@@ -0,0 +1,46 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_BENCH_H
+#define EE500_WIFI_BENCH_H
+
+#include <cstdint>
+#include <string>
+
+// Microbenchmarks of the simulation script, run with --bench=<name>.
+// waf builds all the files of the scratch folder into one program, so the benchmarks
+// live in the simulation binary instead of having their own main().
+
+// Per-frame cost of the PHY trace callbacks: the copying header inspection the
+// callbacks used to do versus the peeking one, on the frames a STA sees on the channel.
+void RunCallbackBenchmark(uint32_t frames);
+
+// Packets per second through the app -> UDP -> IP -> device entry at a very high offered load:
+// the send path Sender used to have versus the current one, each in a simulation of its own.
+void RunSendBenchmark(uint32_t packets);
+
+// Setup wall time of whole scenarios with 1000 to 10000 STAs on one AP, stopped before Simulator::Run(),
+// split into the parts of the setup. The growth is the exponent of the setup time against the STAs
+// from the previous size, 1 is linear.
+void RunSetupBenchmark();
+
+// Runs the benchmark with the given name. Returns false if there is no such benchmark.
+bool RunBenchmark(const std::string &name, uint32_t iterations);
+
+#endif /* EE500_WIFI_BENCH_H */
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "ee500_wifi_convergence.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ConvergenceMonitor");
+
+//------------------------------------------------------------
+//-- BatchMeans
+//------------------------------------------------------------
+
+// 0.975 quantiles of the Student t distribution for 1 to 30 degrees of freedom
+static const double T_QUANTILES[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                     2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                     2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+static double GetTQuantile(uint32_t degrees)
+{
+  if (degrees <= 30)
+  {
+    return T_QUANTILES[degrees - 1];
+  }
+  // Within 0.002 of the exact values up to the 63 degrees MAX_BATCHES allows
+  return 1.96 + 2.5 / degrees;
+}
+
+BatchMeans::BatchMeans() : m_batchSize(1),
+                           m_pending(0),
+                           m_pendingTotal(0),
+                           m_pendingWeight(0)
+{
+  m_totals.reserve(MAX_BATCHES);
+  m_weights.reserve(MAX_BATCHES);
+}
+
+void BatchMeans::Add(double total, double weight)
+{
+  m_pendingTotal += total;
+  m_pendingWeight += weight;
+  if (++m_pending < m_batchSize)
+  {
+    return;
+  }
+  if (m_pendingWeight > 0)
+  {
+    m_totals.push_back(m_pendingTotal);
+    m_weights.push_back(m_pendingWeight);
+  }
+  m_pending = 0;
+  m_pendingTotal = 0;
+  m_pendingWeight = 0;
+
+  if (m_totals.size() == MAX_BATCHES)
+  {
+    for (uint32_t i = 0; i < MAX_BATCHES / 2; ++i)
+    {
+      m_totals[i] = m_totals[2 * i] + m_totals[2 * i + 1];
+      m_weights[i] = m_weights[2 * i] + m_weights[2 * i + 1];
+    }
+    m_totals.resize(MAX_BATCHES / 2);
+    m_weights.resize(MAX_BATCHES / 2);
+    m_batchSize *= 2;
+  }
+}
+
+uint32_t BatchMeans::GetBatches() const
+{
+  return m_totals.size();
+}
+
+double BatchMeans::GetMean() const
+{
+  if (m_totals.empty())
+  {
+    return 0;
+  }
+  double sum = 0;
+  for (uint32_t i = 0; i < m_totals.size(); ++i)
+  {
+    sum += m_totals[i] / m_weights[i];
+  }
+  return sum / m_totals.size();
+}
+
+double BatchMeans::GetRelativeHalfWidth() const
+{
+  uint32_t n = m_totals.size();
+  double mean = GetMean();
+  if (n < 2 || mean == 0)
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+  double squares = 0;
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    double diff = m_totals[i] / m_weights[i] - mean;
+    squares += diff * diff;
+  }
+  double halfWidth = GetTQuantile(n - 1) * std::sqrt(squares / (n - 1) / n);
+  return halfWidth / std::fabs(mean);
+}
+
+//------------------------------------------------------------
+//-- ConvergenceMonitor
+//------------------------------------------------------------
+
+ConvergenceMonitor::ConvergenceMonitor() : m_threshold(0),
+                                           m_batch(MilliSeconds(500)),
+                                           m_warmedUp(false),
+                                           m_converged(false),
+                                           m_lastPackets(0),
+                                           m_lastDelaySum(0)
+{
+}
+
+void ConvergenceMonitor::Setup(double threshold, Time batch)
+{
+  m_threshold = threshold;
+  m_batch = batch;
+}
+
+void ConvergenceMonitor::AddFlow(Ptr<CounterCalculator<>> appRx, Ptr<Receiver> receiver)
+{
+  m_appRx.push_back(appRx);
+  m_receivers.push_back(receiver);
+}
+
+void ConvergenceMonitor::Start(Time start)
+{
+  NS_LOG_FUNCTION(start);
+  m_warmedUp = false;
+  m_converged = false;
+  Simulator::Cancel(m_event);
+  m_event = Simulator::Schedule(start - Simulator::Now() + m_batch, &ConvergenceMonitor::EndBatch, this);
+}
+
+void ConvergenceMonitor::Stop()
+{
+  NS_LOG_FUNCTION_NOARGS();
+  Simulator::Cancel(m_event);
+}
+
+bool ConvergenceMonitor::HasConverged() const
+{
+  return m_converged;
+}
+
+Time ConvergenceMonitor::GetStopTime() const
+{
+  return m_stopTime;
+}
+
+double ConvergenceMonitor::GetThroughputHalfWidth() const
+{
+  return m_throughput.GetRelativeHalfWidth();
+}
+
+double ConvergenceMonitor::GetDelayHalfWidth() const
+{
+  return m_delay.GetRelativeHalfWidth();
+}
+
+void ConvergenceMonitor::EndBatch()
+{
+  uint64_t packets = 0;
+  int64_t delaySum = 0;
+  for (uint32_t i = 0; i < m_appRx.size(); ++i)
+  {
+    packets += m_appRx[i]->GetCount();
+    delaySum += m_receivers[i]->GetDelaySum().GetNanoSeconds();
+  }
+
+  if (m_warmedUp)
+  {
+    double batchPackets = static_cast<double>(packets - m_lastPackets);
+    m_throughput.Add(batchPackets, 1.0);
+    m_delay.Add(static_cast<double>(delaySum - m_lastDelaySum), batchPackets);
+  }
+  m_warmedUp = true;
+  m_lastPackets = packets;
+  m_lastDelaySum = delaySum;
+
+  double throughputHalfWidth = m_throughput.GetRelativeHalfWidth();
+  double delayHalfWidth = m_delay.GetRelativeHalfWidth();
+  NS_LOG_LOGIC("Batch at " << Simulator::Now().GetSeconds() << "s, throughput " << throughputHalfWidth
+                           << ", delay " << delayHalfWidth);
+  if (m_throughput.GetBatches() >= MIN_BATCHES && m_delay.GetBatches() >= MIN_BATCHES &&
+      throughputHalfWidth < m_threshold && delayHalfWidth < m_threshold)
+  {
+    NS_LOG_INFO("Converged at " << Simulator::Now().GetSeconds() << "s");
+    m_converged = true;
+    m_stopTime = Simulator::Now();
+    Simulator::Stop();
+    return;
+  }
+  m_event = Simulator::Schedule(m_batch, &ConvergenceMonitor::EndBatch, this);
+}
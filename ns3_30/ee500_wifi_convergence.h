@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_CONVERGENCE_H
+#define EE500_WIFI_CONVERGENCE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/stats-module.h"
+
+#include "ee500_wifi_app.h"
+
+using namespace ns3;
+
+// Batch means of one metric. Every Add() is one base batch with a total and a weight, the batch
+// mean is total / weight (e.g. delay sum / packets). When MAX_BATCHES batches are kept, adjacent
+// pairs are merged and the batches that follow are twice as long, so the batches get longer as the
+// run does and their means stay close to independent. Batches without weight are left out.
+class BatchMeans
+{
+public:
+  static const uint32_t MAX_BATCHES = 64;
+
+  BatchMeans();
+
+  void Add(double total, double weight);
+
+  uint32_t GetBatches() const;
+  // Mean of the batch means
+  double GetMean() const;
+  // Half-width of the 95% confidence interval of the mean divided by the mean,
+  // infinite with less than two batches or a zero mean
+  double GetRelativeHalfWidth() const;
+
+private:
+  std::vector<double> m_totals;
+  std::vector<double> m_weights;
+  uint32_t m_batchSize;  // base batches per batch
+  uint32_t m_pending;    // base batches in the batch being filled
+  double m_pendingTotal;
+  double m_pendingWeight;
+};
+
+// Stops the simulation once the app throughput and delay of all the flows have converged.
+// At the end of every batch the received packets and the delay sums of the flows are read, the first
+// batch is left out as the warm-up. Once there are MIN_BATCHES batches and the relative half-widths
+// of the confidence intervals of both the throughput and the delay are below the threshold,
+// Simulator::Stop() is called. The stop time at the end of the run still applies as the hard cap.
+class ConvergenceMonitor
+{
+public:
+  static const uint32_t MIN_BATCHES = 10;
+
+  ConvergenceMonitor();
+
+  // Relative half-width at which the run stops and the length of the base batches
+  void Setup(double threshold, Time batch);
+
+  void AddFlow(Ptr<CounterCalculator<>> appRx, Ptr<Receiver> receiver);
+
+  // Schedules the end of the first batch one batch after the given time, e.g. when the traffic starts
+  void Start(Time start);
+  void Stop();
+
+  bool HasConverged() const;
+  // When the simulation was stopped, only valid if it has converged
+  Time GetStopTime() const;
+  double GetThroughputHalfWidth() const;
+  double GetDelayHalfWidth() const;
+
+private:
+  void EndBatch();
+
+  double m_threshold;
+  Time m_batch;
+  EventId m_event;
+  bool m_warmedUp;
+  bool m_converged;
+  Time m_stopTime;
+
+  // Sources, one per flow
+  std::vector<Ptr<CounterCalculator<>>> m_appRx;
+  std::vector<Ptr<Receiver>> m_receivers;
+
+  // Totals over all the flows at the end of the last batch
+  uint64_t m_lastPackets;
+  int64_t m_lastDelaySum; // nanoseconds
+
+  BatchMeans m_throughput; // packets per batch
+  BatchMeans m_delay;      // nanoseconds per packet
+};
+
+#endif /* EE500_WIFI_CONVERGENCE_H */
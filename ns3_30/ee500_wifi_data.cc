@@ -16,6 +16,17 @@
  *
  */
 
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <sqlite3.h>
+#include <unistd.h>
+
 #include "ee500_wifi_data.h"
 
 using namespace ns3;
@@ -35,18 +46,18 @@ ns3::TypeId LocalDataOutput::GetTypeId(void)
 
 void LocalDataOutput::LocalOutputCallback::OutputSingleton(std::string key, std::string variable, int val)
 {
-    m_owner->m_counters[variable + "_" + key] = val;
+    m_owner->m_counters.Set(MetricKeys::Intern(variable, key), val);
 }
 
 void LocalDataOutput::LocalOutputCallback::OutputSingleton(std::string key, std::string variable, uint32_t val)
 {
     // For uint32_t, we can just static_cast to double
-    m_owner->m_counters[variable + "_" + key] = static_cast<double>(val);
+    m_owner->m_counters.Set(MetricKeys::Intern(variable, key), static_cast<double>(val));
 }
 
 void LocalDataOutput::LocalOutputCallback::OutputSingleton(std::string key, std::string variable, double val)
 {
-    m_owner->m_counters[variable + "_" + key] = val;
+    m_owner->m_counters.Set(MetricKeys::Intern(variable, key), val);
 }
 
 void LocalDataOutput::LocalOutputCallback::OutputSingleton(std::string key, std::string variable, std::string val)
@@ -56,7 +67,7 @@ void LocalDataOutput::LocalOutputCallback::OutputSingleton(std::string key, std:
     try
     {
         double value = std::stod(val);
-        m_owner->m_counters[variable + "_" + key] = value;
+        m_owner->m_counters.Set(MetricKeys::Intern(variable, key), value);
     }
     catch (const std::exception &e)
     {
@@ -68,46 +79,60 @@ void LocalDataOutput::LocalOutputCallback::OutputSingleton(std::string key, std:
 void LocalDataOutput::LocalOutputCallback::OutputSingleton(std::string key, std::string variable, ns3::Time val)
 {
     // For ns3::Time, we convert to seconds and then to double
-    m_owner->m_counters[variable + "_" + key] = val.GetSeconds();
+    m_owner->m_counters.Set(MetricKeys::Intern(variable, key), val.GetSeconds());
 }
 
 void LocalDataOutput::LocalOutputCallback::OutputStatistic(std::string key, std::string variable, const ns3::StatisticalSummary *statSum)
 {
-    std::string baseKey = variable + "_" + key;
-    m_owner->m_counters[baseKey + "_min"] = statSum->getMin();
-    m_owner->m_counters[baseKey + "_max"] = statSum->getMax();
-    m_owner->m_counters[baseKey + "_avg"] = statSum->getMean();
-    m_owner->m_counters[baseKey + "_sum"] = statSum->getSum();
+    // Named <variable>_<key>_min etc.
+    m_owner->m_counters.Set(MetricKeys::Intern(variable, key + "_min"), statSum->getMin());
+    m_owner->m_counters.Set(MetricKeys::Intern(variable, key + "_max"), statSum->getMax());
+    m_owner->m_counters.Set(MetricKeys::Intern(variable, key + "_avg"), statSum->getMean());
+    m_owner->m_counters.Set(MetricKeys::Intern(variable, key + "_sum"), statSum->getSum());
+}
+
+// The count of a counter, under <key>_<context> the same as its Output() singleton
+template <typename T>
+static void OutputCounter(const ns3::DataCalculator &calculator, MetricStore &store)
+{
+    const ns3::CounterCalculator<T> &counter = static_cast<const ns3::CounterCalculator<T> &>(calculator);
+    store.Set(MetricKeys::Intern(counter.GetKey(), counter.GetContext()), counter.GetCount());
+}
+
+std::map<ns3::TypeId, LocalDataOutput::CalculatorHandler> &
+LocalDataOutput::GetHandlers()
+{
+    static std::map<ns3::TypeId, CalculatorHandler> handlers = {
+        {ns3::CounterCalculator<double>::GetTypeId(), &OutputCounter<double>},
+        {ns3::CounterCalculator<uint32_t>::GetTypeId(), &OutputCounter<uint32_t>},
+        {ns3::PacketCounterCalculator::GetTypeId(), &OutputCounter<uint32_t>},
+    };
+    return handlers;
+}
+
+void LocalDataOutput::RegisterCalculator(ns3::TypeId tid, CalculatorHandler handler)
+{
+    GetHandlers()[tid] = handler;
 }
 
 void LocalDataOutput::Output(ns3::DataCollector &dc)
 {
+    const std::map<ns3::TypeId, CalculatorHandler> &handlers = GetHandlers();
+    LocalOutputCallback callback(this);
+
     // Iterate over all calculators in the DataCollector
     for (auto it = dc.DataCalculatorBegin(); it != dc.DataCalculatorEnd(); ++it)
     {
-        // Check the type of the calculator
-        if (ns3::CounterCalculator<double> *counterCalc = dynamic_cast<ns3::CounterCalculator<double> *>(PeekPointer(*it)))
-        {
-            std::string key = counterCalc->GetKey() + "_" + counterCalc->GetContext();
-            m_counters[key] = counterCalc->GetCount();
-        }
-        else if (ns3::CounterCalculator<uint32_t> *counterCalcUint32 = dynamic_cast<ns3::CounterCalculator<uint32_t> *>(PeekPointer(*it)))
-        {
-            std::string key = counterCalcUint32->GetKey() + "_" + counterCalcUint32->GetContext();
-            m_counters[key] = counterCalcUint32->GetCount();
-        }
-        else if (ns3::PacketCounterCalculator *packetCounterCalc = dynamic_cast<ns3::PacketCounterCalculator *>(PeekPointer(*it)))
+        auto handler = handlers.find((*it)->GetInstanceTypeId());
+        if (handler != handlers.end())
         {
-            std::string key = packetCounterCalc->GetKey() + "_" + packetCounterCalc->GetContext();
-            m_counters[key] = packetCounterCalc->GetCount();
+            handler->second(**it, m_counters);
         }
-        else if (ns3::TimeMinMaxAvgTotalCalculator *timeCalc = dynamic_cast<ns3::TimeMinMaxAvgTotalCalculator *>(PeekPointer(*it)))
+        else
         {
-            // For TimeMinMaxAvgTotalCalculator we use Output method
-            LocalOutputCallback callback(this);
-            timeCalc->Output(callback);
+            // Other calculators, e.g. TimeMinMaxAvgTotalCalculator or WifiPhyStats, output their own singletons
+            (*it)->Output(callback);
         }
-        // If you have other types of calculators, add them here
     }
 
     // Iterate over all metadata in the DataCollector
@@ -118,7 +143,7 @@ void LocalDataOutput::Output(ns3::DataCollector &dc)
     }
 }
 
-const std::map<std::string, double> &
+const MetricStore &
 LocalDataOutput::GetCounters() const
 {
     return m_counters;
@@ -129,3 +154,576 @@ LocalDataOutput::GetMetadata() const
 {
     return m_metadata;
 }
+
+MetricStore LocalDataOutput::TakeCounters()
+{
+    MetricStore counters = std::move(m_counters);
+    m_counters.Clear();
+    return counters;
+}
+
+std::map<std::string, std::string> LocalDataOutput::TakeMetadata()
+{
+    std::map<std::string, std::string> metadata = std::move(m_metadata);
+    m_metadata.clear();
+    return metadata;
+}
+
+// Expands a statistic into the singletons SqliteDataOutput writes for it: the count, and the total, max, min,
+// sum of squares and standard deviation the summary has
+static void OutputStatisticSingletons(ns3::DataOutputCallback &callback, const std::string &key, const std::string &variable,
+                                      const ns3::StatisticalSummary *statSum)
+{
+    callback.OutputSingleton(key, variable + "-count", static_cast<double>(statSum->getCount()));
+    if (!std::isnan(statSum->getSum()))
+        callback.OutputSingleton(key, variable + "-total", statSum->getSum());
+    if (!std::isnan(statSum->getMax()))
+        callback.OutputSingleton(key, variable + "-max", statSum->getMax());
+    if (!std::isnan(statSum->getMin()))
+        callback.OutputSingleton(key, variable + "-min", statSum->getMin());
+    if (!std::isnan(statSum->getSqrSum()))
+        callback.OutputSingleton(key, variable + "-sqrsum", statSum->getSqrSum());
+    if (!std::isnan(statSum->getStddev()))
+        callback.OutputSingleton(key, variable + "-stddev", statSum->getStddev());
+}
+
+ColumnarDataOutput::ColumnarOutputCallback::ColumnarOutputCallback(ColumnarDataOutput *owner) : m_owner(owner) {}
+
+ns3::TypeId ColumnarDataOutput::GetTypeId(void)
+{
+    static ns3::TypeId tid = ns3::TypeId("ColumnarDataOutput")
+                                 .SetParent<DataOutputInterface>()
+                                 .SetGroupName("Network")
+                                 .AddConstructor<ColumnarDataOutput>();
+    return tid;
+}
+
+void ColumnarDataOutput::ColumnarOutputCallback::OutputSingleton(std::string key, std::string variable, int val)
+{
+    m_owner->SetNumber(key, variable, val);
+}
+
+void ColumnarDataOutput::ColumnarOutputCallback::OutputSingleton(std::string key, std::string variable, uint32_t val)
+{
+    m_owner->SetNumber(key, variable, val);
+}
+
+void ColumnarDataOutput::ColumnarOutputCallback::OutputSingleton(std::string key, std::string variable, double val)
+{
+    m_owner->SetNumber(key, variable, val);
+}
+
+void ColumnarDataOutput::ColumnarOutputCallback::OutputSingleton(std::string key, std::string variable, std::string val)
+{
+    m_owner->SetString(key, variable, val);
+}
+
+void ColumnarDataOutput::ColumnarOutputCallback::OutputSingleton(std::string key, std::string variable, ns3::Time val)
+{
+    // Nanoseconds, the same as the time steps SqliteDataOutput stores
+    m_owner->SetNumber(key, variable, static_cast<double>(val.GetTimeStep()));
+}
+
+void ColumnarDataOutput::ColumnarOutputCallback::OutputStatistic(std::string key, std::string variable, const ns3::StatisticalSummary *statSum)
+{
+    OutputStatisticSingletons(*this, key, variable, statSum);
+}
+
+uint32_t ColumnarDataOutput::GetRow(const std::string &context)
+{
+    auto it = m_rowIndex.find(context);
+    if (it != m_rowIndex.end())
+    {
+        return it->second;
+    }
+    uint32_t row = m_rows.size();
+    m_rows.push_back(context);
+    m_rowIndex[context] = row;
+    // Every column gets a cell for the new row
+    for (auto &column : m_columns)
+    {
+        column.numbers.push_back(std::numeric_limits<double>::quiet_NaN());
+        column.strings.push_back("");
+    }
+    return row;
+}
+
+ColumnarDataOutput::Column &
+ColumnarDataOutput::GetColumn(const std::string &name, char type)
+{
+    auto it = m_columnIndex.find(name);
+    if (it == m_columnIndex.end())
+    {
+        m_columnIndex[name] = m_columns.size();
+        m_columns.push_back(Column());
+        Column &column = m_columns.back();
+        column.name = name;
+        column.type = type;
+        column.numbers.assign(m_rows.size(), std::numeric_limits<double>::quiet_NaN());
+        column.strings.assign(m_rows.size(), "");
+        return column;
+    }
+    Column &column = m_columns[it->second];
+    // A column with any string in it is written as strings, the numbers are kept as text
+    if (type == 's' && column.type == 'd')
+    {
+        column.type = 's';
+        for (uint32_t row = 0; row < column.numbers.size(); ++row)
+        {
+            if (!std::isnan(column.numbers[row]))
+            {
+                std::ostringstream text;
+                text << column.numbers[row];
+                column.strings[row] = text.str();
+            }
+        }
+    }
+    return column;
+}
+
+void ColumnarDataOutput::SetNumber(const std::string &context, const std::string &variable, double value)
+{
+    uint32_t row = GetRow(context);
+    Column &column = GetColumn(variable, 'd');
+    column.numbers[row] = value;
+    if (column.type == 's')
+    {
+        std::ostringstream text;
+        text << value;
+        column.strings[row] = text.str();
+    }
+}
+
+void ColumnarDataOutput::SetString(const std::string &context, const std::string &variable, const std::string &value)
+{
+    uint32_t row = GetRow(context);
+    GetColumn(variable, 's').strings[row] = value;
+}
+
+// Appends a string column with the same value on every row
+static void AppendConstantColumn(std::string &table, const std::string &name, const std::string &value, uint64_t rows)
+{
+    uint32_t length = name.size();
+    table.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    table.append(name);
+    // Numbers are written as numbers, the way the notebook converts the metadata anyway
+    char *end = 0;
+    double number = std::strtod(value.c_str(), &end);
+    if (!value.empty() && *end == '\0')
+    {
+        table.push_back('d');
+        for (uint64_t row = 0; row < rows; ++row)
+        {
+            table.append(reinterpret_cast<const char *>(&number), sizeof(number));
+        }
+        return;
+    }
+    table.push_back('s');
+    length = value.size();
+    for (uint64_t row = 0; row < rows; ++row)
+    {
+        table.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        table.append(value);
+    }
+}
+
+void ColumnarDataOutput::Output(ns3::DataCollector &dc)
+{
+    m_rows.clear();
+    m_rowIndex.clear();
+    m_columns.clear();
+    m_columnIndex.clear();
+
+    // Every calculator outputs its own singletons, the same as for SqliteDataOutput
+    ColumnarOutputCallback callback(this);
+    for (auto it = dc.DataCalculatorBegin(); it != dc.DataCalculatorEnd(); ++it)
+    {
+        (*it)->Output(callback);
+    }
+
+    // The whole table is put together in memory and written with one call, so a table is never half appended
+    static_assert(sizeof(double) == 8, "columns are written as 8-byte values");
+    uint64_t rows = m_rows.size();
+    std::string table;
+    uint32_t columns = 0;
+    table.append(sizeof(columns) + sizeof(rows), '\0'); // filled in at the end
+
+    // The run labels, the same as the Experiments table
+    AppendConstantColumn(table, "run", dc.GetRunLabel(), rows);
+    AppendConstantColumn(table, "experiment", dc.GetExperimentLabel(), rows);
+    AppendConstantColumn(table, "strategy", dc.GetStrategyLabel(), rows);
+    AppendConstantColumn(table, "input", dc.GetInputLabel(), rows);
+    AppendConstantColumn(table, "description", dc.GetDescription(), rows);
+    columns += 5;
+    for (auto it = dc.MetadataBegin(); it != dc.MetadataEnd(); ++it)
+    {
+        AppendConstantColumn(table, it->first, it->second, rows);
+        columns++;
+    }
+
+    // The contexts as the notebook names them
+    uint32_t length = 7;
+    table.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    table.append("node_id");
+    table.push_back('s');
+    for (auto &context : m_rows)
+    {
+        length = context.size();
+        table.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        table.append(context);
+    }
+    columns++;
+
+    for (auto &column : m_columns)
+    {
+        length = column.name.size();
+        table.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        table.append(column.name);
+        table.push_back(column.type);
+        if (column.type == 'd')
+        {
+            table.append(reinterpret_cast<const char *>(column.numbers.data()), rows * sizeof(double));
+        }
+        else
+        {
+            for (auto &value : column.strings)
+            {
+                length = value.size();
+                table.append(reinterpret_cast<const char *>(&length), sizeof(length));
+                table.append(value);
+            }
+        }
+        columns++;
+    }
+    table.replace(0, sizeof(columns), reinterpret_cast<const char *>(&columns), sizeof(columns));
+    table.replace(sizeof(columns), sizeof(rows), reinterpret_cast<const char *>(&rows), sizeof(rows));
+
+    std::string fileName = m_filePrefix + ".cols";
+    std::ofstream out(fileName.c_str(), std::ios::binary | std::ios::app);
+    uint64_t size = table.size();
+    out.write("EE500RC1", 8);
+    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.write(table.data(), table.size());
+    if (!out)
+    {
+        NS_LOG_ERROR("Can't write " << fileName);
+        std::cout << "Can't write the results to " << fileName << std::endl;
+    }
+}
+
+bool MergeColumnarShards(const std::vector<std::string> &shards, const std::string &target)
+{
+    for (auto &shard : shards)
+    {
+        // A worker that got no points never creates its shard
+        if (access(shard.c_str(), F_OK) != 0)
+        {
+            continue;
+        }
+        std::ifstream in(shard.c_str(), std::ios::binary);
+        std::ofstream out(target.c_str(), std::ios::binary | std::ios::app);
+        if (in.peek() != std::ifstream::traits_type::eof())
+        {
+            out << in.rdbuf();
+        }
+        if (!in || !out)
+        {
+            std::cout << "Can't append " << shard << " to " << target << std::endl;
+            return false;
+        }
+        in.close();
+        // Merged shards are removed right away, so a failed merge can be repeated with the rest
+        std::remove(shard.c_str());
+    }
+    return true;
+}
+
+static bool ExecSql(sqlite3 *db, const std::string &sql)
+{
+    char *errMsg = 0;
+    if (sqlite3_exec(db, sql.c_str(), 0, 0, &errMsg) != SQLITE_OK)
+    {
+        NS_LOG_ERROR("SQLite error in \"" << sql << "\": " << errMsg);
+        std::cout << "SQLite error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+// The tables SqliteDataOutput creates, so the notebook reads every database the same way,
+// and the indices the notebook's queries need
+static bool CreateSqliteSchema(sqlite3 *db)
+{
+    return ExecSql(db, "CREATE TABLE IF NOT EXISTS Experiments (run, experiment, strategy, input, description text)") &&
+           ExecSql(db, "CREATE TABLE IF NOT EXISTS Metadata ( run text, key text, value)") &&
+           ExecSql(db, "CREATE TABLE IF NOT EXISTS Singletons ( run text, name text, variable text, value )") &&
+           ExecSql(db, "CREATE INDEX IF NOT EXISTS Metadata_run ON Metadata (run)") &&
+           ExecSql(db, "CREATE INDEX IF NOT EXISTS Singletons_run ON Singletons (run)") &&
+           ExecSql(db, "CREATE INDEX IF NOT EXISTS Singletons_variable ON Singletons (variable)");
+}
+
+// Databases kept open by BatchedSqliteDataOutput, by file name.
+// The ones still open when the process exits are closed by the destructor.
+struct SqliteDatabases
+{
+    std::map<std::string, sqlite3 *> handles;
+
+    ~SqliteDatabases()
+    {
+        Close();
+    }
+
+    void Close()
+    {
+        for (auto &handle : handles)
+        {
+            // The last connection checkpoints the WAL into the database and removes it
+            sqlite3_close(handle.second);
+        }
+        handles.clear();
+    }
+};
+
+static SqliteDatabases g_sqliteDatabases;
+
+void CloseSqliteDatabases()
+{
+    g_sqliteDatabases.Close();
+}
+
+static sqlite3 *OpenSqliteDatabase(const std::string &fileName)
+{
+    auto it = g_sqliteDatabases.handles.find(fileName);
+    if (it != g_sqliteDatabases.handles.end())
+    {
+        return it->second;
+    }
+
+    sqlite3 *db = 0;
+    if (sqlite3_open(fileName.c_str(), &db) != SQLITE_OK)
+    {
+        std::cout << "Can't open " << fileName << ": " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return 0;
+    }
+    // Other processes appending to the same database hold the write lock for one run at most
+    sqlite3_busy_timeout(db, 60000);
+    if (!ExecSql(db, "PRAGMA journal_mode=WAL") ||
+        !ExecSql(db, "PRAGMA synchronous=NORMAL") ||
+        !CreateSqliteSchema(db))
+    {
+        sqlite3_close(db);
+        return 0;
+    }
+    g_sqliteDatabases.handles[fileName] = db;
+    return db;
+}
+
+static sqlite3_stmt *PrepareSql(sqlite3 *db, const std::string &sql)
+{
+    sqlite3_stmt *stmt = 0;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, 0) != SQLITE_OK)
+    {
+        NS_LOG_ERROR("SQLite error in \"" << sql << "\": " << sqlite3_errmsg(db));
+        std::cout << "SQLite error: " << sqlite3_errmsg(db) << std::endl;
+        return 0;
+    }
+    return stmt;
+}
+
+// Runs a prepared insert and resets it for the next row
+static bool StepSql(sqlite3_stmt *stmt)
+{
+    bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+    if (!ok)
+    {
+        NS_LOG_ERROR("SQLite error: " << sqlite3_errmsg(sqlite3_db_handle(stmt)));
+    }
+    sqlite3_reset(stmt);
+    return ok;
+}
+
+BatchedSqliteDataOutput::BatchedOutputCallback::BatchedOutputCallback(sqlite3_stmt *insert, const std::string &run)
+    : m_insert(insert),
+      m_run(run),
+      m_ok(true)
+{
+}
+
+void BatchedSqliteDataOutput::BatchedOutputCallback::Bind(const std::string &key, const std::string &variable)
+{
+    sqlite3_bind_text(m_insert, 1, m_run.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(m_insert, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(m_insert, 3, variable.c_str(), -1, SQLITE_TRANSIENT);
+}
+
+void BatchedSqliteDataOutput::BatchedOutputCallback::Insert()
+{
+    m_ok = StepSql(m_insert) && m_ok;
+}
+
+bool BatchedSqliteDataOutput::BatchedOutputCallback::IsOk() const
+{
+    return m_ok;
+}
+
+void BatchedSqliteDataOutput::BatchedOutputCallback::OutputSingleton(std::string key, std::string variable, int val)
+{
+    Bind(key, variable);
+    sqlite3_bind_int(m_insert, 4, val);
+    Insert();
+}
+
+void BatchedSqliteDataOutput::BatchedOutputCallback::OutputSingleton(std::string key, std::string variable, uint32_t val)
+{
+    Bind(key, variable);
+    sqlite3_bind_int64(m_insert, 4, val);
+    Insert();
+}
+
+void BatchedSqliteDataOutput::BatchedOutputCallback::OutputSingleton(std::string key, std::string variable, double val)
+{
+    Bind(key, variable);
+    sqlite3_bind_double(m_insert, 4, val);
+    Insert();
+}
+
+void BatchedSqliteDataOutput::BatchedOutputCallback::OutputSingleton(std::string key, std::string variable, std::string val)
+{
+    Bind(key, variable);
+    sqlite3_bind_text(m_insert, 4, val.c_str(), -1, SQLITE_TRANSIENT);
+    Insert();
+}
+
+void BatchedSqliteDataOutput::BatchedOutputCallback::OutputSingleton(std::string key, std::string variable, ns3::Time val)
+{
+    // Time steps (nanoseconds), the same as SqliteDataOutput
+    Bind(key, variable);
+    sqlite3_bind_int64(m_insert, 4, val.GetTimeStep());
+    Insert();
+}
+
+void BatchedSqliteDataOutput::BatchedOutputCallback::OutputStatistic(std::string key, std::string variable, const ns3::StatisticalSummary *statSum)
+{
+    OutputStatisticSingletons(*this, key, variable, statSum);
+}
+
+ns3::TypeId BatchedSqliteDataOutput::GetTypeId(void)
+{
+    static ns3::TypeId tid = ns3::TypeId("BatchedSqliteDataOutput")
+                                 .SetParent<DataOutputInterface>()
+                                 .SetGroupName("Network")
+                                 .AddConstructor<BatchedSqliteDataOutput>();
+    return tid;
+}
+
+void BatchedSqliteDataOutput::Output(ns3::DataCollector &dc)
+{
+    std::string fileName = m_filePrefix + ".db";
+    sqlite3 *db = OpenSqliteDatabase(fileName);
+    if (db == 0)
+    {
+        return;
+    }
+
+    sqlite3_stmt *experiment = PrepareSql(db, "INSERT INTO Experiments (run, experiment, strategy, input, description) VALUES (?, ?, ?, ?, ?)");
+    sqlite3_stmt *metadata = PrepareSql(db, "INSERT INTO Metadata (run, key, value) VALUES (?, ?, ?)");
+    sqlite3_stmt *singleton = PrepareSql(db, "INSERT INTO Singletons (run, name, variable, value) VALUES (?, ?, ?, ?)");
+    // IMMEDIATE takes the write lock up front, a busy database is waited for here and not halfway through
+    bool ok = experiment && metadata && singleton && ExecSql(db, "BEGIN IMMEDIATE");
+    if (ok)
+    {
+        std::string run = dc.GetRunLabel();
+        std::string labels[] = {run, dc.GetExperimentLabel(), dc.GetStrategyLabel(), dc.GetInputLabel(), dc.GetDescription()};
+        for (int i = 0; i < 5; ++i)
+        {
+            sqlite3_bind_text(experiment, i + 1, labels[i].c_str(), -1, SQLITE_TRANSIENT);
+        }
+        ok = StepSql(experiment);
+
+        for (auto it = dc.MetadataBegin(); ok && it != dc.MetadataEnd(); ++it)
+        {
+            sqlite3_bind_text(metadata, 1, run.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(metadata, 2, it->first.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(metadata, 3, it->second.c_str(), -1, SQLITE_TRANSIENT);
+            ok = StepSql(metadata);
+        }
+
+        // Every calculator outputs its own singletons, the same as for SqliteDataOutput
+        BatchedOutputCallback callback(singleton, run);
+        for (auto it = dc.DataCalculatorBegin(); ok && it != dc.DataCalculatorEnd(); ++it)
+        {
+            (*it)->Output(callback);
+            ok = callback.IsOk();
+        }
+
+        ok = ok && ExecSql(db, "COMMIT");
+        if (!ok)
+        {
+            ExecSql(db, "ROLLBACK");
+        }
+    }
+    if (!ok)
+    {
+        std::cout << "Can't write the results of run " << dc.GetRunLabel() << " to " << fileName << std::endl;
+    }
+    sqlite3_finalize(experiment);
+    sqlite3_finalize(metadata);
+    sqlite3_finalize(singleton);
+}
+
+bool MergeSqliteShards(const std::vector<std::string> &shards, const std::string &target)
+{
+    sqlite3 *db = 0;
+    if (sqlite3_open(target.c_str(), &db) != SQLITE_OK)
+    {
+        std::cout << "Can't open " << target << ": " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+    sqlite3_busy_timeout(db, 60000);
+
+    // Same schema as SqliteDataOutput, so the notebook reads the merged database as is
+    bool ok = ExecSql(db, "PRAGMA journal_mode=WAL") && CreateSqliteSchema(db);
+
+    for (auto it = shards.begin(); ok && it != shards.end(); ++it)
+    {
+        // A worker that got no points never creates its shard
+        if (access(it->c_str(), F_OK) != 0)
+        {
+            continue;
+        }
+
+        // SQLite can't attach or detach inside a transaction, so every shard gets its own
+        char *attach = sqlite3_mprintf("ATTACH DATABASE %Q AS shard", it->c_str());
+        ok = ExecSql(db, attach);
+        sqlite3_free(attach);
+        if (!ok)
+        {
+            break;
+        }
+        ok = ExecSql(db, "BEGIN IMMEDIATE") &&
+             ExecSql(db, "INSERT INTO Experiments SELECT run, experiment, strategy, input, description FROM shard.Experiments") &&
+             ExecSql(db, "INSERT INTO Metadata SELECT run, key, value FROM shard.Metadata") &&
+             ExecSql(db, "INSERT INTO Singletons SELECT run, name, variable, value FROM shard.Singletons") &&
+             ExecSql(db, "COMMIT");
+        if (!ok)
+        {
+            ExecSql(db, "ROLLBACK");
+        }
+        ExecSql(db, "DETACH DATABASE shard");
+
+        if (ok)
+        {
+            // Merged shards are removed right away, so a failed merge can be repeated with the rest.
+            // Their workers closed them, so there's no WAL left, the files are removed just in case.
+            std::remove(it->c_str());
+            std::remove((*it + "-wal").c_str());
+            std::remove((*it + "-shm").c_str());
+        }
+    }
+
+    sqlite3_close(db);
+    return ok;
+}
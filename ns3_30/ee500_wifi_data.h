@@ -16,8 +16,12 @@
  *
  */
 
+#ifndef EE500_WIFI_DATA_H
+#define EE500_WIFI_DATA_H
+
 #include <map>
 #include <string>
+#include <vector>
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -25,18 +29,37 @@
 #include "ns3/application.h"
 #include "ns3/stats-module.h"
 
+#include "ee500_wifi_metrics.h"
+
+struct sqlite3_stmt;
+
 using namespace ns3;
 
+// Keeps the results of a run in memory: the metrics in a MetricStore, named <variable>_<context>
+// (e.g. "delay-average_node[1]"), and the metadata.
+// Calculators output their metrics through DataOutputCallback, the same as for any other output.
+// The types whose values can be read directly (the counters) register a handler instead,
+// which writes them to the store without the callback and its string copies.
 class LocalDataOutput : public ns3::DataOutputInterface
 {
 public:
+    // Writes the metrics of a calculator to the store
+    typedef void (*CalculatorHandler)(const ns3::DataCalculator &calculator, MetricStore &store);
+
     static ns3::TypeId GetTypeId(void);
 
+    // Handles the calculators of exactly this type with the handler instead of their Output()
+    static void RegisterCalculator(ns3::TypeId tid, CalculatorHandler handler);
+
     virtual void Output(ns3::DataCollector &dc);
 
-    const std::map<std::string, double> &GetCounters() const;
+    const MetricStore &GetCounters() const;
     const std::map<std::string, std::string> &GetMetadata() const;
 
+    // Move the results out, so they aren't copied into the results of the run
+    MetricStore TakeCounters();
+    std::map<std::string, std::string> TakeMetadata();
+
 private:
     class LocalOutputCallback : public ns3::DataOutputCallback
     {
@@ -55,6 +78,122 @@ private:
         LocalDataOutput *m_owner;
     };
 
-    std::map<std::string, double> m_counters;
+    static std::map<ns3::TypeId, CalculatorHandler> &GetHandlers();
+
+    MetricStore m_counters;
     std::map<std::string, std::string> m_metadata;
 };
+
+// Writes the results of a run as a wide columnar table, the same values SqliteDataOutput writes
+// as one row per singleton. There is one row per context (node[i], aggregate) and one column per
+// variable, after the run, experiment, strategy, input, description, node_id and metadata columns,
+// which repeat on every row. Metadata that parses as a number is written as a number.
+// Every run appends a self-describing table to <prefix>.cols, so files can be concatenated:
+//   "EE500RC1"                                 8 bytes, magic and format version
+//   uint64 size of the rest of the table in bytes
+//   uint32 number of columns, uint64 number of rows
+//   for every column: uint32 name length, name, char type ('d' double, 's' string), then the values:
+//                     'd' 8 bytes each, little endian, NaN where the context has no value
+//                     's' uint32 length and the bytes of every value
+// Time values are in nanoseconds, the same as in the database.
+class ColumnarDataOutput : public ns3::DataOutputInterface
+{
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    virtual void Output(ns3::DataCollector &dc);
+
+private:
+    struct Column
+    {
+        std::string name;
+        char type;                          // 'd' or 's'
+        std::vector<double> numbers;        // by row
+        std::vector<std::string> strings;   // by row
+    };
+
+    class ColumnarOutputCallback : public ns3::DataOutputCallback
+    {
+    public:
+        ColumnarOutputCallback(ColumnarDataOutput *owner);
+
+        // Inherited via DataOutputCallback, need to implement all of them
+        virtual void OutputSingleton(std::string key, std::string variable, int val);
+        virtual void OutputSingleton(std::string key, std::string variable, double val);
+        virtual void OutputSingleton(std::string key, std::string variable, uint32_t val);
+        virtual void OutputSingleton(std::string key, std::string variable, std::string val);
+        virtual void OutputSingleton(std::string key, std::string variable, ns3::Time val);
+        virtual void OutputStatistic(std::string key, std::string variable, const ns3::StatisticalSummary *statSum);
+
+    private:
+        ColumnarDataOutput *m_owner;
+    };
+
+    uint32_t GetRow(const std::string &context);
+    Column &GetColumn(const std::string &name, char type);
+    void SetNumber(const std::string &context, const std::string &variable, double value);
+    void SetString(const std::string &context, const std::string &variable, const std::string &value);
+
+    // Rows in the order their contexts were first output, columns in the order of their variables
+    std::vector<std::string> m_rows;
+    std::map<std::string, uint32_t> m_rowIndex;
+    std::vector<Column> m_columns;
+    std::map<std::string, uint32_t> m_columnIndex;
+};
+
+// Writes the same tables SqliteDataOutput does (Experiments, Metadata and Singletons), but for
+// many runs in a row. The database is opened once per process and kept open, in WAL mode, so
+// readers don't block the writers. All the rows of a run are inserted with prepared statements
+// in a single transaction, so a run is either all in or not in at all, and several processes can
+// append their runs to the same database. Singletons are indexed by run and by variable.
+class BatchedSqliteDataOutput : public ns3::DataOutputInterface
+{
+public:
+    static ns3::TypeId GetTypeId(void);
+
+    virtual void Output(ns3::DataCollector &dc);
+
+private:
+    class BatchedOutputCallback : public ns3::DataOutputCallback
+    {
+    public:
+        // Binds the run and every singleton to the prepared insert statement
+        BatchedOutputCallback(sqlite3_stmt *insert, const std::string &run);
+
+        // Inherited via DataOutputCallback, need to implement all of them
+        virtual void OutputSingleton(std::string key, std::string variable, int val);
+        virtual void OutputSingleton(std::string key, std::string variable, double val);
+        virtual void OutputSingleton(std::string key, std::string variable, uint32_t val);
+        virtual void OutputSingleton(std::string key, std::string variable, std::string val);
+        virtual void OutputSingleton(std::string key, std::string variable, ns3::Time val);
+        virtual void OutputStatistic(std::string key, std::string variable, const ns3::StatisticalSummary *statSum);
+
+        // False once an insert has failed
+        bool IsOk() const;
+
+    private:
+        // Binds the run, key and variable, the value is bound by the caller, then inserts the row
+        void Bind(const std::string &key, const std::string &variable);
+        void Insert();
+
+        sqlite3_stmt *m_insert;
+        std::string m_run;
+        bool m_ok;
+    };
+};
+
+// Closes the databases BatchedSqliteDataOutput keeps open. They are closed when the process exits,
+// but a forked worker that leaves with _exit() has to close them itself, and so does a process
+// before it forks.
+void CloseSqliteDatabases();
+
+// Appends the columnar result files of the shards to the target file and removes them.
+// The tables are self-describing, so appending the bytes is all a merge takes.
+bool MergeColumnarShards(const std::vector<std::string> &shards, const std::string &target);
+
+// Appends the Experiments, Metadata and Singletons tables of the SQLite database shards
+// to the target database, creating the tables the same way SqliteDataOutput does.
+// Every shard is appended in its own transaction and removed once it is merged.
+bool MergeSqliteShards(const std::vector<std::string> &shards, const std::string &target);
+
+#endif /* EE500_WIFI_DATA_H */
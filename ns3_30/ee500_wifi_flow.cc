@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "ee500_wifi_flow.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("FlowStats");
+
+//------------------------------------------------------------
+//-- FlowStats
+//------------------------------------------------------------
+
+FlowStats::FlowStats() : m_highest(-1),
+                         m_retired(0),
+                         m_burst(0),
+                         m_received(0),
+                         m_duplicates(0),
+                         m_reordered(0),
+                         m_late(0),
+                         m_lost(0),
+                         m_lossBursts(0),
+                         m_maxLossBurst(0),
+                         m_hasTransit(false),
+                         m_lastTransit(0),
+                         m_jitter(0),
+                         m_flows(0)
+{
+  std::memset(m_window, 0, sizeof(m_window));
+  std::memset(m_burstHistogram, 0, sizeof(m_burstHistogram));
+}
+
+void FlowStats::Update(uint32_t sequence, int64_t transit)
+{
+  int64_t seq = sequence;
+  uint64_t bit = 1ULL << (seq % 64);
+  uint64_t &word = m_window[(seq % WINDOW) / 64];
+
+  if (seq > m_highest)
+  {
+    // The window moves up, the sequences sliding out of it are decided
+    Retire(seq - WINDOW + 1);
+    m_highest = seq;
+  }
+  else if (seq < m_retired)
+  {
+    m_late++;
+    return;
+  }
+  else if (word & bit)
+  {
+    m_duplicates++;
+    return;
+  }
+  else
+  {
+    m_reordered++;
+  }
+  word |= bit;
+  m_received++;
+
+  // RFC 3550, 6.4.1: J += (|D| - J) / 16, D being the difference of the transit times of two packets
+  if (m_hasTransit)
+  {
+    double d = std::llabs(transit - m_lastTransit);
+    m_jitter += (d - m_jitter) / 16.0;
+  }
+  else
+  {
+    m_hasTransit = true;
+    m_flows = 1;
+  }
+  m_lastTransit = transit;
+}
+
+void FlowStats::Retire(int64_t upTo)
+{
+  if (upTo <= m_retired)
+  {
+    return;
+  }
+
+  // Only the sequences up to the highest one can have been received, the rest are lost for sure
+  int64_t seen = std::min(upTo, m_highest + 1);
+  for (int64_t seq = m_retired; seq < seen; ++seq)
+  {
+    uint64_t bit = 1ULL << (seq % 64);
+    uint64_t &word = m_window[(seq % WINDOW) / 64];
+    if (word & bit)
+    {
+      word &= ~bit;
+      EndBurst();
+    }
+    else
+    {
+      m_burst++;
+      m_lost++;
+    }
+  }
+  if (upTo > seen)
+  {
+    m_burst += upTo - seen;
+    m_lost += upTo - seen;
+  }
+  m_retired = upTo;
+}
+
+void FlowStats::EndBurst()
+{
+  if (m_burst == 0)
+  {
+    return;
+  }
+  m_lossBursts++;
+  m_maxLossBurst = std::max(m_maxLossBurst, m_burst);
+  m_burstHistogram[GetBurstBucket(m_burst)]++;
+  m_burst = 0;
+}
+
+void FlowStats::Flush()
+{
+  // The highest sequence was received, so the last burst ends there
+  Retire(m_highest + 1);
+  EndBurst();
+}
+
+void FlowStats::Merge(const FlowStats &other)
+{
+  uint32_t flows = m_flows + other.m_flows;
+  if (flows > 0)
+  {
+    m_jitter = (m_jitter * m_flows + other.m_jitter * other.m_flows) / flows;
+  }
+  m_flows = flows;
+
+  m_received += other.m_received;
+  m_duplicates += other.m_duplicates;
+  m_reordered += other.m_reordered;
+  m_late += other.m_late;
+  m_lost += other.m_lost;
+  m_lossBursts += other.m_lossBursts;
+  m_maxLossBurst = std::max(m_maxLossBurst, other.m_maxLossBurst);
+  for (uint32_t i = 0; i < BURST_BUCKETS; ++i)
+  {
+    m_burstHistogram[i] += other.m_burstHistogram[i];
+  }
+}
+
+uint64_t FlowStats::GetReceived() const
+{
+  return m_received;
+}
+
+uint64_t FlowStats::GetDuplicates() const
+{
+  return m_duplicates;
+}
+
+uint64_t FlowStats::GetReordered() const
+{
+  return m_reordered;
+}
+
+uint64_t FlowStats::GetLate() const
+{
+  return m_late;
+}
+
+uint64_t FlowStats::GetLost() const
+{
+  return m_lost;
+}
+
+uint64_t FlowStats::GetLossBursts() const
+{
+  return m_lossBursts;
+}
+
+uint64_t FlowStats::GetMaxLossBurst() const
+{
+  return m_maxLossBurst;
+}
+
+uint64_t FlowStats::GetLossBurstCount(uint32_t bucket) const
+{
+  return m_burstHistogram[bucket];
+}
+
+double FlowStats::GetJitter() const
+{
+  return m_jitter;
+}
+
+uint32_t FlowStats::GetBurstBucket(uint64_t length)
+{
+  // 1 -> 0, 2 -> 1, 3-4 -> 2, 5-8 -> 3, ...
+  uint32_t bucket = 0;
+  while (bucket < BURST_BUCKETS - 1 && (1ULL << bucket) < length)
+  {
+    bucket++;
+  }
+  return bucket;
+}
+
+std::string FlowStats::GetBurstBucketName(uint32_t bucket)
+{
+  if (bucket == 0)
+  {
+    return "1";
+  }
+  if (bucket == BURST_BUCKETS - 1)
+  {
+    return std::to_string((1ULL << (bucket - 1)) + 1) + "+";
+  }
+  if (bucket == 1)
+  {
+    return "2";
+  }
+  return std::to_string((1ULL << (bucket - 1)) + 1) + "-" + std::to_string(1ULL << bucket);
+}
+
+//------------------------------------------------------------
+//-- FlowStatsCalculator
+//------------------------------------------------------------
+
+TypeId
+FlowStatsCalculator::GetTypeId(void)
+{
+  static TypeId tid = TypeId("FlowStatsCalculator")
+                          .SetParent<DataCalculator>()
+                          .AddConstructor<FlowStatsCalculator>();
+  return tid;
+}
+
+FlowStatsCalculator::FlowStatsCalculator()
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+FlowStatsCalculator::~FlowStatsCalculator()
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+void FlowStatsCalculator::DoDispose(void)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  // chain up
+  DataCalculator::DoDispose();
+}
+
+void FlowStatsCalculator::Merge(const FlowStatsCalculator &other)
+{
+  m_stats.Merge(other.GetStats());
+}
+
+FlowStats
+FlowStatsCalculator::GetStats() const
+{
+  FlowStats stats = m_stats;
+  stats.Flush();
+  return stats;
+}
+
+void FlowStatsCalculator::Output(DataOutputCallback &callback) const
+{
+  FlowStats stats = GetStats();
+  callback.OutputSingleton(m_context, m_key + "-jitter", NanoSeconds(static_cast<int64_t>(stats.GetJitter())));
+  callback.OutputSingleton(m_context, m_key + "-received", static_cast<uint32_t>(stats.GetReceived()));
+  callback.OutputSingleton(m_context, m_key + "-duplicates", static_cast<uint32_t>(stats.GetDuplicates()));
+  callback.OutputSingleton(m_context, m_key + "-reordered", static_cast<uint32_t>(stats.GetReordered()));
+  callback.OutputSingleton(m_context, m_key + "-late", static_cast<uint32_t>(stats.GetLate()));
+  callback.OutputSingleton(m_context, m_key + "-lost", static_cast<uint32_t>(stats.GetLost()));
+  callback.OutputSingleton(m_context, m_key + "-loss-bursts", static_cast<uint32_t>(stats.GetLossBursts()));
+  callback.OutputSingleton(m_context, m_key + "-loss-burst-max", static_cast<uint32_t>(stats.GetMaxLossBurst()));
+  for (uint32_t i = 0; i < FlowStats::BURST_BUCKETS; ++i)
+  {
+    callback.OutputSingleton(m_context, m_key + "-loss-burst-" + FlowStats::GetBurstBucketName(i),
+                             static_cast<uint32_t>(stats.GetLossBurstCount(i)));
+  }
+}
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_FLOW_H
+#define EE500_WIFI_FLOW_H
+
+#include <cstdint>
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/stats-module.h"
+
+using namespace ns3;
+
+// Receive-side statistics of one sequence-numbered flow, in constant memory.
+// The last WINDOW sequences below the highest one received are kept in a bitmap, which tells
+// duplicates from reordered packets. A sequence is decided lost when it slides out of the window
+// without having been received, so the runs of lost sequences build the loss-burst histogram.
+// Packets older than the window are counted as late (they are already counted as lost).
+// Losses after the highest sequence received can't be seen here, the Sender counter covers them.
+class FlowStats
+{
+public:
+  static const uint32_t WINDOW = 1024;
+  static const uint32_t BURST_BUCKETS = 8; // burst lengths 1, 2, 3-4, 5-8, ..., 33-64, 65+
+
+  FlowStats();
+
+  // A packet with the given sequence number, transit time = receive time - send time (ns)
+  void Update(uint32_t sequence, int64_t transit);
+
+  // Decides the sequences still in the window, as if the flow was over
+  void Flush();
+
+  // Adds the counters of another flow, the jitter becomes the average of the flows.
+  // Both flows are expected to be flushed.
+  void Merge(const FlowStats &other);
+
+  uint64_t GetReceived() const;
+  uint64_t GetDuplicates() const;
+  uint64_t GetReordered() const;
+  uint64_t GetLate() const;
+  uint64_t GetLost() const;
+  uint64_t GetLossBursts() const;
+  uint64_t GetMaxLossBurst() const;
+  uint64_t GetLossBurstCount(uint32_t bucket) const;
+  double GetJitter() const; // ns, RFC 3550 interarrival jitter
+
+  static uint32_t GetBurstBucket(uint64_t length);
+  static std::string GetBurstBucketName(uint32_t bucket);
+
+private:
+  void Retire(int64_t upTo);
+  void EndBurst();
+
+  uint64_t m_window[WINDOW / 64]; // bit (sequence % WINDOW) is set if the sequence was received
+  int64_t m_highest;              // highest sequence received, -1 before the first packet
+  int64_t m_retired;              // sequences below this one are decided
+  uint64_t m_burst;               // length of the run of lost sequences being retired
+
+  uint64_t m_received;
+  uint64_t m_duplicates;
+  uint64_t m_reordered;
+  uint64_t m_late;
+  uint64_t m_lost;
+  uint64_t m_lossBursts;
+  uint64_t m_maxLossBurst;
+  uint64_t m_burstHistogram[BURST_BUCKETS];
+
+  bool m_hasTransit;
+  int64_t m_lastTransit;
+  double m_jitter;
+  uint32_t m_flows; // number of flows with packets merged into this one
+};
+
+// Jitter, reordering, duplicate and loss-burst statistics of one Receiver (or of several, merged).
+// Output() writes <key>-jitter as a Time singleton, <key>-received, -duplicates, -reordered, -late,
+// -lost, -loss-bursts, -loss-burst-max and the histogram <key>-loss-burst-<lengths> as counters.
+class FlowStatsCalculator : public DataCalculator
+{
+public:
+  static TypeId GetTypeId(void);
+  FlowStatsCalculator();
+  virtual ~FlowStatsCalculator();
+
+  inline void Update(uint32_t sequence, Time transit)
+  {
+    if (m_enabled)
+    {
+      m_stats.Update(sequence, transit.GetNanoSeconds());
+    }
+  }
+
+  void Merge(const FlowStatsCalculator &other);
+
+  // The statistics with the sequences still in the window decided
+  FlowStats GetStats() const;
+
+  virtual void Output(DataOutputCallback &callback) const;
+
+protected:
+  virtual void DoDispose(void);
+
+private:
+  FlowStats m_stats;
+};
+
+#endif /* EE500_WIFI_FLOW_H */
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "ee500_wifi_metrics.h"
+
+//------------------------------------------------------------
+//-- MetricKeys
+//------------------------------------------------------------
+
+MetricKeys::MetricKeys()
+{
+}
+
+MetricKeys &
+MetricKeys::Get()
+{
+  static MetricKeys keys;
+  return keys;
+}
+
+uint32_t MetricKeys::InternPart(std::unordered_map<std::string, uint32_t> &parts, const std::string &name)
+{
+  auto it = parts.find(name);
+  if (it != parts.end())
+  {
+    return it->second;
+  }
+  uint32_t id = parts.size();
+  parts.emplace(name, id);
+  return id;
+}
+
+uint32_t MetricKeys::Intern(const std::string &variable, const std::string &context)
+{
+  MetricKeys &keys = Get();
+  uint64_t pair = static_cast<uint64_t>(InternPart(keys.m_variables, variable)) << 32 |
+                  InternPart(keys.m_contexts, context);
+  auto it = keys.m_ids.find(pair);
+  if (it != keys.m_ids.end())
+  {
+    return it->second;
+  }
+  // The only place the name is built
+  uint32_t id = keys.m_names.size();
+  keys.m_names.push_back(variable + "_" + context);
+  keys.m_ids.emplace(pair, id);
+  return id;
+}
+
+uint32_t MetricKeys::Find(const std::string &variable, const std::string &context)
+{
+  MetricKeys &keys = Get();
+  auto variableIt = keys.m_variables.find(variable);
+  auto contextIt = keys.m_contexts.find(context);
+  if (variableIt == keys.m_variables.end() || contextIt == keys.m_contexts.end())
+  {
+    return NONE;
+  }
+  auto it = keys.m_ids.find(static_cast<uint64_t>(variableIt->second) << 32 | contextIt->second);
+  return it != keys.m_ids.end() ? it->second : NONE;
+}
+
+const std::string &
+MetricKeys::GetName(uint32_t id)
+{
+  return Get().m_names[id];
+}
+
+uint32_t MetricKeys::GetSize()
+{
+  return Get().m_names.size();
+}
+
+//------------------------------------------------------------
+//-- MetricStore
+//------------------------------------------------------------
+
+void MetricStore::Set(uint32_t id, double value)
+{
+  if (id >= m_values.size())
+  {
+    // Every metric interned so far fits, so a run grows the arrays a few times at most
+    uint32_t size = std::max(id + 1, MetricKeys::GetSize());
+    m_values.resize(size, std::numeric_limits<double>::quiet_NaN());
+    m_set.resize(size, false);
+  }
+  if (!m_set[id])
+  {
+    m_set[id] = true;
+    m_ids.push_back(id);
+  }
+  m_values[id] = value;
+}
+
+bool MetricStore::Has(uint32_t id) const
+{
+  return id < m_set.size() && m_set[id];
+}
+
+double MetricStore::Get(uint32_t id) const
+{
+  return Has(id) ? m_values[id] : std::numeric_limits<double>::quiet_NaN();
+}
+
+bool MetricStore::Find(const std::string &variable, const std::string &context, double &value) const
+{
+  uint32_t id = MetricKeys::Find(variable, context);
+  if (!Has(id))
+  {
+    return false;
+  }
+  value = m_values[id];
+  return true;
+}
+
+const std::vector<uint32_t> &
+MetricStore::GetIds() const
+{
+  return m_ids;
+}
+
+std::vector<uint32_t> MetricStore::GetSortedIds() const
+{
+  std::vector<uint32_t> ids = m_ids;
+  std::sort(ids.begin(), ids.end(), [](uint32_t a, uint32_t b) {
+    return MetricKeys::GetName(a) < MetricKeys::GetName(b);
+  });
+  return ids;
+}
+
+uint32_t MetricStore::GetSize() const
+{
+  return m_ids.size();
+}
+
+void MetricStore::Clear()
+{
+  m_values.clear();
+  m_set.clear();
+  m_ids.clear();
+}
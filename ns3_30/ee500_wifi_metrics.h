@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_METRICS_H
+#define EE500_WIFI_METRICS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Names of the metrics, interned once per process.
+// A metric is a variable of a context, e.g. "delay-average" of "node[1]", named "delay-average_node[1]".
+// Its id indexes every MetricStore, and the runs of a sweep output the same metrics,
+// so after the first run a metric costs two hash lookups and no strings are built.
+class MetricKeys
+{
+public:
+  static const uint32_t NONE = 0xffffffff;
+
+  // Id of the metric, added if it's new
+  static uint32_t Intern(const std::string &variable, const std::string &context);
+  // Id of the metric, NONE if it was never added
+  static uint32_t Find(const std::string &variable, const std::string &context);
+
+  static const std::string &GetName(uint32_t id);
+  static uint32_t GetSize();
+
+private:
+  MetricKeys();
+  static MetricKeys &Get();
+
+  // Id of a variable or context name, added if it's new
+  static uint32_t InternPart(std::unordered_map<std::string, uint32_t> &parts, const std::string &name);
+
+  std::unordered_map<std::string, uint32_t> m_variables;
+  std::unordered_map<std::string, uint32_t> m_contexts;
+  std::unordered_map<uint64_t, uint32_t> m_ids;  // (variable << 32 | context) to metric id
+  std::vector<std::string> m_names;              // by metric id
+};
+
+// The metrics of one run, a flat array of values indexed by the MetricKeys id.
+class MetricStore
+{
+public:
+  void Set(uint32_t id, double value);
+
+  bool Has(uint32_t id) const;
+  // The value of the metric, NaN if it's not set
+  double Get(uint32_t id) const;
+  // The value of a metric by its names, false if it's not set
+  bool Find(const std::string &variable, const std::string &context, double &value) const;
+
+  // Ids of the metrics that are set, in the order they were first set
+  const std::vector<uint32_t> &GetIds() const;
+  // The same ids ordered by metric name
+  std::vector<uint32_t> GetSortedIds() const;
+
+  uint32_t GetSize() const;
+  void Clear();
+
+private:
+  std::vector<double> m_values;  // by id
+  std::vector<bool> m_set;       // by id
+  std::vector<uint32_t> m_ids;
+};
+
+#endif /* EE500_WIFI_METRICS_H */
@@ -0,0 +1,318 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "ee500_wifi_propagation.h"
+
+NS_LOG_COMPONENT_DEFINE("WifiPropagation");
+
+//------------------------------------------------------------
+//-- PathLossMatrix
+//------------------------------------------------------------
+
+const uint32_t PathLossMatrix::MAX_NODES;
+const uint32_t PathLossMatrix::NOT_FOUND;
+
+TypeId
+PathLossMatrix::GetTypeId(void)
+{
+  static TypeId tid = TypeId("PathLossMatrix")
+                          .SetParent<PropagationLossModel>()
+                          .AddConstructor<PathLossMatrix>();
+  return tid;
+}
+
+// The defaults of LogDistancePropagationLossModel
+PathLossMatrix::PathLossMatrix() : m_exponent(3.0),
+                                   m_referenceLoss(46.6777),
+                                   m_referenceDistance(1.0),
+                                   m_n(0),
+                                   m_lastA(0),
+                                   m_lastB(0)
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+PathLossMatrix::~PathLossMatrix()
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+void PathLossMatrix::SetLogDistance(double exponent, double referenceLoss, double referenceDistance)
+{
+  m_exponent = exponent;
+  m_referenceLoss = referenceLoss;
+  m_referenceDistance = referenceDistance;
+}
+
+double PathLossMatrix::GetGain(double distance) const
+{
+  if (distance <= m_referenceDistance)
+  {
+    return -m_referenceLoss;
+  }
+  double pathLossDb = 10 * m_exponent * std::log10(distance / m_referenceDistance);
+  return -m_referenceLoss - pathLossDb;
+}
+
+bool PathLossMatrix::Build(const NodeContainer &nodes)
+{
+  uint32_t n = nodes.GetN();
+  if (n > MAX_NODES)
+  {
+    std::cout << "Too many nodes for the path loss matrix: " << n << ", at most " << MAX_NODES << std::endl;
+    return false;
+  }
+
+  m_models.clear();
+  m_indices.clear();
+  // The positions as separate arrays, so the distances of a row are computed in one pass the compiler can vectorize
+  std::vector<double> xs(n), ys(n), zs(n);
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    Ptr<MobilityModel> mobility = nodes.Get(i)->GetObject<MobilityModel>();
+    if (mobility == 0)
+    {
+      std::cout << "Node " << i << " has no mobility model for the path loss matrix" << std::endl;
+      return false;
+    }
+    Vector position = mobility->GetPosition();
+    xs[i] = position.x;
+    ys[i] = position.y;
+    zs[i] = position.z;
+    m_models.push_back(PeekPointer(mobility));
+    m_indices[PeekPointer(mobility)] = i;
+  }
+
+  m_n = n;
+  m_gains.assign(static_cast<size_t>(n) * n, -m_referenceLoss);
+  std::vector<double> distances(n);
+  for (uint32_t a = 0; a < n; ++a)
+  {
+    // Only the pairs above the diagonal, the distance and so the gain are symmetric:
+    // the squares of the differences are the same both ways.
+    double x = xs[a], y = ys[a], z = zs[a];
+    for (uint32_t b = a + 1; b < n; ++b)
+    {
+      double dx = x - xs[b];
+      double dy = y - ys[b];
+      double dz = z - zs[b];
+      distances[b] = std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+    double *row = &m_gains[static_cast<size_t>(a) * n];
+    for (uint32_t b = a + 1; b < n; ++b)
+    {
+      double gain = GetGain(distances[b]);
+      row[b] = gain;
+      m_gains[static_cast<size_t>(b) * n + a] = gain;
+    }
+  }
+  NS_LOG_INFO("Path loss matrix of " << n << " nodes");
+  return true;
+}
+
+uint32_t PathLossMatrix::GetN() const
+{
+  return m_n;
+}
+
+uint32_t PathLossMatrix::FindIndex(const MobilityModel *model, uint32_t hint) const
+{
+  if (hint < m_n && m_models[hint] == model)
+  {
+    return hint;
+  }
+  auto it = m_indices.find(model);
+  return it != m_indices.end() ? it->second : NOT_FOUND;
+}
+
+double PathLossMatrix::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  // The sender stays the same for all the receivers of a frame, the receivers come in order
+  uint32_t indexA = FindIndex(PeekPointer(a), m_lastA);
+  uint32_t indexB = FindIndex(PeekPointer(b), m_lastB + 1);
+  if (indexA == NOT_FOUND || indexB == NOT_FOUND)
+  {
+    return txPowerDbm + GetGain(a->GetDistanceFrom(b));
+  }
+  m_lastA = indexA;
+  m_lastB = indexB;
+  return txPowerDbm + m_gains[static_cast<size_t>(indexA) * m_n + indexB];
+}
+
+int64_t PathLossMatrix::DoAssignStreams(int64_t stream)
+{
+  return 0;
+}
+
+//------------------------------------------------------------
+//-- RangeLimitedChannels
+//------------------------------------------------------------
+
+RangeLimitedChannels::RangeLimitedChannels(const YansWifiChannelHelper &helper, Ptr<PropagationLossModel> loss)
+    : m_helper(helper),
+      m_loss(loss),
+      m_exponent(3.0),
+      m_referenceLoss(46.6777),
+      m_referenceDistance(1.0),
+      m_links(0),
+      m_pairs(0)
+{
+}
+
+void RangeLimitedChannels::SetLogDistance(double exponent, double referenceLoss, double referenceDistance)
+{
+  m_exponent = exponent;
+  m_referenceLoss = referenceLoss;
+  m_referenceDistance = referenceDistance;
+}
+
+Ptr<YansWifiChannel> RangeLimitedChannels::Create()
+{
+  Ptr<YansWifiChannel> channel = m_helper.Create();
+  channel->SetPropagationLossModel(m_loss);
+  m_channels.push_back(channel);
+  return channel;
+}
+
+bool RangeLimitedChannels::Connect(const NetDeviceContainer &devices, double marginDb)
+{
+  uint32_t n = devices.GetN();
+  if (n != m_channels.size())
+  {
+    std::cout << "Range limit: " << n << " devices for " << m_channels.size() << " channels" << std::endl;
+    return false;
+  }
+
+  std::vector<Ptr<YansWifiPhy>> phys(n);
+  std::vector<Ptr<MobilityModel>> mobilities(n);
+  std::vector<double> txPowers(n);
+  std::vector<double> rxGains(n);
+  std::vector<double> floors(n);
+  double maxTxPower = -std::numeric_limits<double>::max();
+  double minFloor = std::numeric_limits<double>::max();
+  double minX = std::numeric_limits<double>::max(), maxX = -std::numeric_limits<double>::max();
+  double minY = std::numeric_limits<double>::max(), maxY = -std::numeric_limits<double>::max();
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(devices.Get(i));
+    if (device != 0)
+    {
+      phys[i] = DynamicCast<YansWifiPhy>(device->GetPhy());
+      mobilities[i] = device->GetNode()->GetObject<MobilityModel>();
+    }
+    if (phys[i] == 0 || mobilities[i] == 0 || PeekPointer(phys[i]->GetChannel()) != PeekPointer(m_channels[i]))
+    {
+      std::cout << "Range limit: device " << i << " is not a YansWifiPhy with a mobility model on its own channel" << std::endl;
+      return false;
+    }
+    // The highest power a frame can be sent at, and what YansWifiChannel drops on arrival
+    txPowers[i] = std::max(phys[i]->GetTxPowerStart(), phys[i]->GetTxPowerEnd()) + phys[i]->GetTxGain();
+    rxGains[i] = phys[i]->GetRxGain();
+    floors[i] = phys[i]->GetRxSensitivity() - marginDb;
+    maxTxPower = std::max(maxTxPower, txPowers[i]);
+    minFloor = std::min(minFloor, floors[i] - rxGains[i]);
+
+    Vector position = mobilities[i]->GetPosition();
+    minX = std::min(minX, position.x);
+    maxX = std::max(maxX, position.x);
+    minY = std::min(minY, position.y);
+    maxY = std::max(maxY, position.y);
+  }
+  if (n == 0)
+  {
+    return true;
+  }
+
+  // Beyond the range even the loudest sender is below the lowest floor. The cells are at least that wide,
+  // so every pair in range is in the same or neighbouring cells. Wider cells only mean more pairs checked,
+  // they are doubled until there are at most a few cells per node.
+  double width = maxX - minX;
+  double height = maxY - minY;
+  double range = m_referenceDistance * std::pow(10.0, (maxTxPower - m_referenceLoss - minFloor) / (10 * m_exponent));
+  double cell = std::max(range, m_referenceDistance) * (1 + 1e-9);
+  int32_t cols = 1;
+  int32_t rows = 1;
+  if (m_exponent > 0 && std::isfinite(cell))
+  {
+    while ((width / cell + 1) * (height / cell + 1) > 4.0 * n)
+    {
+      cell *= 2;
+    }
+    cols = static_cast<int32_t>(width / cell) + 1;
+    rows = static_cast<int32_t>(height / cell) + 1;
+  }
+  auto getCol = [&](double x) { return std::min(cols - 1, static_cast<int32_t>((x - minX) / cell)); };
+  auto getRow = [&](double y) { return std::min(rows - 1, static_cast<int32_t>((y - minY) / cell)); };
+
+  std::vector<std::vector<uint32_t>> buckets(cols * rows);
+  std::vector<int32_t> nodeCols(n), nodeRows(n);
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    Vector position = mobilities[i]->GetPosition();
+    nodeCols[i] = cols > 1 ? getCol(position.x) : 0;
+    nodeRows[i] = rows > 1 ? getRow(position.y) : 0;
+    buckets[nodeRows[i] * cols + nodeCols[i]].push_back(i);
+  }
+
+  m_links = 0;
+  m_pairs = static_cast<uint64_t>(n) * (n - 1);
+  std::vector<uint32_t> receivers;
+  for (uint32_t a = 0; a < n; ++a)
+  {
+    receivers.clear();
+    for (int32_t y = std::max(0, nodeRows[a] - 1); y <= std::min(rows - 1, nodeRows[a] + 1); ++y)
+    {
+      for (int32_t x = std::max(0, nodeCols[a] - 1); x <= std::min(cols - 1, nodeCols[a] + 1); ++x)
+      {
+        for (uint32_t b : buckets[y * cols + x])
+        {
+          // The same comparison YansWifiChannel makes when the frame arrives
+          if (b != a && !(m_loss->CalcRxPower(txPowers[a], mobilities[a], mobilities[b]) + rxGains[b] < floors[b]))
+          {
+            receivers.push_back(b);
+          }
+        }
+      }
+    }
+    // In the order of the shared channel, so the receive events are scheduled in the same order
+    std::sort(receivers.begin(), receivers.end());
+    for (uint32_t b : receivers)
+    {
+      m_channels[a]->Add(phys[b]);
+    }
+    m_links += receivers.size();
+  }
+  NS_LOG_INFO("Range limit of " << range << " m, " << m_links << " of " << m_pairs << " links kept");
+  return true;
+}
+
+uint64_t RangeLimitedChannels::GetLinks() const
+{
+  return m_links;
+}
+
+uint64_t RangeLimitedChannels::GetPairs() const
+{
+  return m_pairs;
+}
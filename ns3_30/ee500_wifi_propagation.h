@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_PROPAGATION_H
+#define EE500_WIFI_PROPAGATION_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+#include "ns3/wifi-module.h"
+
+using namespace ns3;
+
+// Log-distance path loss of static nodes, computed once for every pair of nodes after they are placed.
+// The gains are the ones LogDistancePropagationLossModel computes, with the same arithmetic,
+// kept in a flat row-major table, so a transmission reads one contiguous row of it instead of
+// computing log10 of the distance to every receiver.
+// YansWifiChannel asks for the receivers in the same order for every frame, so the index of the
+// next receiver is guessed from the previous one and the hash table is only a fallback.
+// The nodes must not move after Build(), pairs it doesn't know are computed on the fly.
+class PathLossMatrix : public PropagationLossModel
+{
+public:
+  // The table takes N x N doubles, 512 MB for the largest one
+  static const uint32_t MAX_NODES = 8192;
+
+  static TypeId GetTypeId(void);
+  PathLossMatrix();
+  virtual ~PathLossMatrix();
+
+  // Same parameters as the Exponent, ReferenceLoss and ReferenceDistance attributes of LogDistancePropagationLossModel
+  void SetLogDistance(double exponent, double referenceLoss, double referenceDistance);
+
+  // Computes the gains between the mobility models of all the nodes.
+  // Returns false if there are more than MAX_NODES nodes or a node has no mobility model.
+  bool Build(const NodeContainer &nodes);
+
+  uint32_t GetN() const;
+
+private:
+  virtual double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams(int64_t stream);
+
+  // Gain in dB at the distance, the same as LogDistancePropagationLossModel
+  double GetGain(double distance) const;
+  // Index of the mobility model, the hint is tried first. NOT_FOUND if it's not in the table.
+  uint32_t FindIndex(const MobilityModel *model, uint32_t hint) const;
+
+  static const uint32_t NOT_FOUND = 0xffffffff;
+
+  double m_exponent;
+  double m_referenceLoss;
+  double m_referenceDistance;
+
+  uint32_t m_n;
+  std::vector<double> m_gains;                 // m_gains[a * m_n + b] in dB
+  std::vector<const MobilityModel *> m_models; // by index
+  std::unordered_map<const MobilityModel *, uint32_t> m_indices;
+
+  // The indices of the last pair, the next lookups start from them
+  mutable uint32_t m_lastA;
+  mutable uint32_t m_lastB;
+};
+
+// Range-limited delivery on top of YansWifiChannel.
+// A YansWifiChannel hands every frame to all of its PHYs and schedules a receive event for each one,
+// the ones far below the sensitivity are only dropped when the event runs. Here every PHY gets a channel
+// of its own, holding only the PHYs that receive it above their RxSensitivity less a margin,
+// so a frame costs as many events as there are PHYs in range. The pairs are found once after placement
+// with a grid of cells as wide as the longest range. The receivers keep the order they have on a shared channel.
+class RangeLimitedChannels
+{
+public:
+  // The channels are created by the helper and all get the loss model, which must be deterministic
+  RangeLimitedChannels(const YansWifiChannelHelper &helper, Ptr<PropagationLossModel> loss);
+
+  // Log-distance parameters of the loss model, bound the range searched on the grid
+  void SetLogDistance(double exponent, double referenceLoss, double referenceDistance);
+
+  // The channel of the next PHY installed, to be set on the YansWifiPhyHelper before every Install()
+  Ptr<YansWifiChannel> Create();
+
+  // Adds to the channel of every PHY the PHYs that receive its frames at the highest Tx power at
+  // or above their RxSensitivity less marginDb. The devices are the ones installed, in the same order.
+  // With a margin of 0 or more the results are the same as with a shared channel.
+  // The nodes must not move afterwards. Returns false if the devices don't match the channels.
+  bool Connect(const NetDeviceContainer &devices, double marginDb);
+
+  // Sender-receiver pairs kept, out of all the pairs
+  uint64_t GetLinks() const;
+  uint64_t GetPairs() const;
+
+private:
+  YansWifiChannelHelper m_helper;
+  Ptr<PropagationLossModel> m_loss;
+  double m_exponent;
+  double m_referenceLoss;
+  double m_referenceDistance;
+
+  std::vector<Ptr<YansWifiChannel>> m_channels; // by device
+  uint64_t m_links;
+  uint64_t m_pairs;
+};
+
+#endif /* EE500_WIFI_PROPAGATION_H */
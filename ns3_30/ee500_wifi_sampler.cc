@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <cstring>
+#include <fstream>
+
+#include "ee500_wifi_sampler.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("WifiSampler");
+
+static void CountFrame(uint64_t *counter, Ptr<const Packet> packet)
+{
+  (*counter)++;
+}
+
+WifiSampler::WifiSampler() : m_interval(MilliSeconds(100)),
+                             m_samples(0),
+                             m_macs(1),
+                             m_capacity(0)
+{
+}
+
+void WifiSampler::Setup(Time interval, uint32_t capacity)
+{
+  m_interval = interval;
+  m_capacity = capacity;
+}
+
+void WifiSampler::AddStation(Ptr<CounterCalculator<>> appTx, Ptr<CounterCalculator<>> appRx, Ptr<Receiver> receiver,
+                             Ptr<WifiMac> mac)
+{
+  m_appTx.push_back(appTx);
+  m_appRx.push_back(appRx);
+  m_receivers.push_back(receiver);
+  m_macs.push_back(mac);
+}
+
+void WifiSampler::SetAp(Ptr<WifiMac> mac)
+{
+  m_macs[0] = mac;
+}
+
+void WifiSampler::SetPhyStats(Ptr<WifiPhyStats> phyStats)
+{
+  m_phyStats = phyStats;
+}
+
+void WifiSampler::Start()
+{
+  NS_LOG_FUNCTION_NOARGS();
+
+  m_macTx.assign(m_macs.size(), 0);
+  m_macRx.assign(m_macs.size(), 0);
+  for (uint32_t n = 0; n < m_macs.size(); ++n)
+  {
+    if (m_macs[n] != 0)
+    {
+      m_macs[n]->TraceConnectWithoutContext("MacTx", MakeBoundCallback(&CountFrame, &m_macTx[n]));
+      m_macs[n]->TraceConnectWithoutContext("MacRx", MakeBoundCallback(&CountFrame, &m_macRx[n]));
+    }
+  }
+
+  // All the memory of the samples is allocated here, sampling itself doesn't allocate
+  size_t rows = static_cast<size_t>(m_capacity) * m_macs.size();
+  m_time.Reserve(rows);
+  m_node.Reserve(rows);
+  m_appTxPackets.Reserve(rows);
+  m_appRxPackets.Reserve(rows);
+  m_appDelaySum.Reserve(rows);
+  m_macTxFrames.Reserve(rows);
+  m_macRxFrames.Reserve(rows);
+  m_phyRxCount.Reserve(rows);
+  m_phyRxBytes.Reserve(rows);
+  m_phyDropCount.Reserve(rows);
+  m_phyRssSum.Reserve(rows);
+
+  m_samples = 0;
+  Simulator::Cancel(m_event);
+  m_event = Simulator::ScheduleNow(&WifiSampler::Sample, this);
+}
+
+void WifiSampler::Stop()
+{
+  NS_LOG_FUNCTION_NOARGS();
+  Simulator::Cancel(m_event);
+}
+
+uint32_t WifiSampler::GetNSamples() const
+{
+  return m_samples < m_capacity ? m_samples : m_capacity;
+}
+
+void WifiSampler::Sample()
+{
+  double now = Simulator::Now().GetSeconds();
+  for (uint32_t n = 0; n < m_macs.size(); ++n)
+  {
+    m_time.Push(now);
+    m_node.Push(n);
+    m_macTxFrames.Push(m_macTx[n]);
+    m_macRxFrames.Push(m_macRx[n]);
+
+    if (n == 0)
+    {
+      // The AP row only has the MAC counters, the app and PHY counters are per STA
+      m_appTxPackets.Push(0);
+      m_appRxPackets.Push(0);
+      m_appDelaySum.Push(0);
+      m_phyRxCount.Push(0);
+      m_phyRxBytes.Push(0);
+      m_phyDropCount.Push(0);
+      m_phyRssSum.Push(0.0);
+      continue;
+    }
+
+    uint32_t sta = n - 1;
+    m_appTxPackets.Push(m_appTx[sta]->GetCount());
+    m_appRxPackets.Push(m_appRx[sta]->GetCount());
+    m_appDelaySum.Push(m_receivers[sta]->GetDelaySum().GetNanoSeconds());
+    if (m_phyStats != 0)
+    {
+      const StaPhyCounters &counters = m_phyStats->GetCounters(sta);
+      m_phyRxCount.Push(counters.rxCount);
+      m_phyRxBytes.Push(counters.rxBytes);
+      m_phyDropCount.Push(counters.dropCount);
+      m_phyRssSum.Push(counters.rssSum);
+    }
+    else
+    {
+      m_phyRxCount.Push(0);
+      m_phyRxBytes.Push(0);
+      m_phyDropCount.Push(0);
+      m_phyRssSum.Push(0.0);
+    }
+  }
+  m_samples++;
+
+  m_event = Simulator::Schedule(m_interval, &WifiSampler::Sample, this);
+}
+
+template <typename T>
+static void WriteColumn(std::ofstream &out, const std::string &name, char type, const RingBuffer<T> &column)
+{
+  uint32_t nameLength = name.size();
+  out.write(reinterpret_cast<const char *>(&nameLength), sizeof(nameLength));
+  out.write(name.data(), nameLength);
+  out.write(&type, 1);
+  for (size_t i = 0; i < column.Size(); ++i)
+  {
+    const T &value = column.At(i);
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+}
+
+bool WifiSampler::Write(const std::string &fileName) const
+{
+  std::ofstream out(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out)
+  {
+    NS_LOG_ERROR("Can't open " << fileName);
+    return false;
+  }
+
+  static_assert(sizeof(double) == 8, "columns are written as 8-byte values");
+  out.write("EE500TS1", 8);
+  uint32_t columns = 11;
+  uint64_t rows = m_time.Size();
+  out.write(reinterpret_cast<const char *>(&columns), sizeof(columns));
+  out.write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+
+  WriteColumn(out, "time", 'd', m_time);
+  WriteColumn(out, "node", 'u', m_node);
+  WriteColumn(out, "app-tx-packets", 'u', m_appTxPackets);
+  WriteColumn(out, "app-rx-packets", 'u', m_appRxPackets);
+  WriteColumn(out, "app-delay-sum", 'i', m_appDelaySum);
+  WriteColumn(out, "mac-tx-frames", 'u', m_macTxFrames);
+  WriteColumn(out, "mac-rx-frames", 'u', m_macRxFrames);
+  WriteColumn(out, "phy-mpdu-rx-count", 'u', m_phyRxCount);
+  WriteColumn(out, "phy-mpdu-rx-bytes", 'u', m_phyRxBytes);
+  WriteColumn(out, "phy-mpdu-drop-count", 'u', m_phyDropCount);
+  WriteColumn(out, "phy-mpdu-rx-rss-sum", 'd', m_phyRssSum);
+
+  return out.good();
+}
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_SAMPLER_H
+#define EE500_WIFI_SAMPLER_H
+
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/stats-module.h"
+
+#include "ee500_wifi_app.h"
+#include "ee500_wifi_stats.h"
+
+using namespace ns3;
+
+// Fixed size ring buffer. The storage is allocated once by Reserve(),
+// when it's full a Push() overwrites the oldest value.
+template <typename T>
+class RingBuffer
+{
+public:
+  RingBuffer() : m_head(0), m_size(0) {}
+
+  void Reserve(size_t capacity)
+  {
+    m_data.assign(capacity, T());
+    m_head = 0;
+    m_size = 0;
+  }
+
+  void Push(const T &value)
+  {
+    if (m_data.empty())
+    {
+      return;
+    }
+    m_data[(m_head + m_size) % m_data.size()] = value;
+    if (m_size < m_data.size())
+    {
+      m_size++;
+    }
+    else
+    {
+      m_head = (m_head + 1) % m_data.size();
+    }
+  }
+
+  size_t Size() const
+  {
+    return m_size;
+  }
+
+  // i = 0 is the oldest value
+  const T &At(size_t i) const
+  {
+    return m_data[(m_head + i) % m_data.size()];
+  }
+
+private:
+  std::vector<T> m_data;
+  size_t m_head;
+  size_t m_size;
+};
+
+// Snapshots the app, MAC and PHY counters of every node at a fixed interval while the simulation runs.
+// Every sample adds one row per node: node 0 is the AP, nodes 1 to staNum are the STAs.
+// All the counters are cumulative since the start of the run, the rates over time are the differences
+// between consecutive samples divided by the interval.
+//
+// Samples are kept in one preallocated ring buffer per column. If the run is longer than the
+// capacity, the oldest samples are overwritten. At the end of the run the columns are written
+// to a binary file, one column after another:
+//   "EE500TS1"                                 8 bytes, magic and format version
+//   uint32 number of columns, uint64 number of rows
+//   for every column: uint32 name length, name, char type ('d' double, 'u' uint64, 'i' int64),
+//                     then the values, 8 bytes each, little endian
+class WifiSampler
+{
+public:
+  WifiSampler();
+
+  // Interval between samples and the maximum number of samples kept
+  void Setup(Time interval, uint32_t capacity);
+
+  // Counters of the STA with the given ordinal (0 for the first STA)
+  void AddStation(Ptr<CounterCalculator<>> appTx, Ptr<CounterCalculator<>> appRx, Ptr<Receiver> receiver,
+                  Ptr<WifiMac> mac);
+  void SetAp(Ptr<WifiMac> mac);
+  void SetPhyStats(Ptr<WifiPhyStats> phyStats);
+
+  // Connects the MAC traces, allocates the columns and schedules the first sample at the current time
+  void Start();
+  void Stop();
+
+  uint32_t GetNSamples() const;
+
+  // Writes the columns to the file. Returns false if the file can't be written.
+  bool Write(const std::string &fileName) const;
+
+private:
+  void Sample();
+
+  Time m_interval;
+  EventId m_event;
+  uint32_t m_samples;
+
+  // Sources, indexed by the STA ordinal
+  std::vector<Ptr<CounterCalculator<>>> m_appTx;
+  std::vector<Ptr<CounterCalculator<>>> m_appRx;
+  std::vector<Ptr<Receiver>> m_receivers;
+  Ptr<WifiPhyStats> m_phyStats;
+
+  // MACs and their counters, index 0 is the AP, the STAs follow.
+  // The counters are updated by the MacTx/MacRx traces, which are bound to the elements.
+  std::vector<Ptr<WifiMac>> m_macs;
+  std::vector<uint64_t> m_macTx;
+  std::vector<uint64_t> m_macRx;
+  uint32_t m_capacity;
+
+  // Columns
+  RingBuffer<double> m_time;           // seconds
+  RingBuffer<uint64_t> m_node;
+  RingBuffer<uint64_t> m_appTxPackets;
+  RingBuffer<uint64_t> m_appRxPackets;
+  RingBuffer<int64_t> m_appDelaySum;   // nanoseconds
+  RingBuffer<uint64_t> m_macTxFrames;
+  RingBuffer<uint64_t> m_macRxFrames;
+  RingBuffer<uint64_t> m_phyRxCount;
+  RingBuffer<uint64_t> m_phyRxBytes;
+  RingBuffer<uint64_t> m_phyDropCount;
+  RingBuffer<double> m_phyRssSum;      // dBm
+};
+
+#endif /* EE500_WIFI_SAMPLER_H */
@@ -0,0 +1,1939 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <iomanip> // Necessary for std::setw and std::setfill
+#include <limits>
+#include <sys/resource.h>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/stats-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/wifi-phy.h"
+
+#include "ee500_wifi_analytic.h"
+#include "ee500_wifi_app.h"
+#include "ee500_wifi_convergence.h"
+#include "ee500_wifi_data.h"
+#include "ee500_wifi_flow.h"
+#include "ee500_wifi_propagation.h"
+#include "ee500_wifi_sampler.h"
+#include "ee500_wifi_scenario.h"
+#include "ee500_wifi_stats.h"
+#include "ee500_wifi_topology.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ee500_WiFi_Sim");
+
+//------------------------------------------------------------
+//-- Scenario configuration
+//------------------------------------------------------------
+
+// The values of the enumerated parameters, Run() knows no others
+static const std::map<std::string, std::vector<std::string>> SCENARIO_CHOICES = {
+    {"standard", {"b", "a", "g", "n", "n24", "ac", "ax", "ax24"}},
+    {"rateControl", {"minstrel", "minstrelht", "constant"}},
+    {"strategy", {"wifi-linear", "wifi-radial"}},
+    {"trafficModel", {"cbr", "poisson", "onoff-exp", "onoff-pareto", "saturated"}},
+    {"packetSizeDist", {"constant", "uniform", "exponential"}},
+    {"direction", {"downlink", "uplink", "both"}},
+    {"output", {"sqlite", "columnar", "both"}},
+    {"layout", {"", "grid", "random", "clustered", "floorplan"}},
+};
+
+// False if the parameter is enumerated and the value isn't one of its values
+static bool IsScenarioChoice(const std::string &name, const std::string &value)
+{
+  auto it = SCENARIO_CHOICES.find(name);
+  return it == SCENARIO_CHOICES.end() || std::find(it->second.begin(), it->second.end(), value) != it->second.end();
+}
+
+// The parsers of the parameter values take nothing but a number or a boolean, they leave the
+// parameter as it was otherwise. std::stoul() and friends would stop at the first bad character,
+// skip leading spaces and take "-1" as the largest unsigned value.
+static bool ParseDouble(const std::string &value, double &number)
+{
+  if (value.empty() || std::isspace(static_cast<unsigned char>(value[0])))
+  {
+    return false;
+  }
+  try
+  {
+    size_t end;
+    double parsed = std::stod(value, &end);
+    if (end != value.size() || !std::isfinite(parsed))
+    {
+      return false;
+    }
+    number = parsed;
+    return true;
+  }
+  catch (const std::exception &e)
+  {
+    return false;
+  }
+}
+
+template <typename T>
+static bool ParseUnsigned(const std::string &value, T &number)
+{
+  if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0])))
+  {
+    return false;
+  }
+  try
+  {
+    size_t end;
+    unsigned long long parsed = std::stoull(value, &end);
+    if (end != value.size() || parsed > std::numeric_limits<T>::max())
+    {
+      return false;
+    }
+    number = parsed;
+    return true;
+  }
+  catch (const std::exception &e)
+  {
+    return false;
+  }
+}
+
+static bool ParseBool(const std::string &value, bool &flag)
+{
+  if (value == "true" || value == "1")
+  {
+    flag = true;
+  }
+  else if (value == "false" || value == "0")
+  {
+    flag = false;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+static bool ParseChoice(const std::string &name, const std::string &value, std::string &choice)
+{
+  if (!IsScenarioChoice(name, value))
+  {
+    return false;
+  }
+  choice = value;
+  return true;
+}
+
+// Comma separated distances in meters, e.g. "10,20,30"
+static bool IsDistanceList(const std::string &value)
+{
+  std::stringstream ss(value);
+  std::string item;
+  double distance;
+  while (std::getline(ss, item, ','))
+  {
+    if (!ParseDouble(item, distance))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool ParseDistances(const std::string &value, std::string &distances)
+{
+  if (!IsDistanceList(value))
+  {
+    return false;
+  }
+  distances = value;
+  return true;
+}
+
+bool SetScenarioParameter(WifiScenarioConfig &config, const std::string &name, const std::string &value)
+{
+  bool ok = true;
+  if (name == "distance")
+    ok = ParseDouble(value, config.distance);
+  else if (name == "duration")
+    ok = ParseDouble(value, config.duration);
+  else if (name == "desiredDataRate")
+    ok = ParseUnsigned(value, config.desiredDataRate);
+  else if (name == "packetSize")
+    ok = ParseUnsigned(value, config.packetSize);
+  else if (name == "packetNum")
+    ok = ParseUnsigned(value, config.packetNum);
+  else if (name == "verbose")
+    ok = ParseBool(value, config.verbose);
+  else if (name == "pcap")
+    ok = ParseBool(value, config.pcap);
+  else if (name == "staNum")
+    ok = ParseUnsigned(value, config.staNum);
+  else if (name == "debug")
+    ok = ParseBool(value, config.debug);
+  else if (name == "standard")
+    ok = ParseChoice(name, value, config.standard);
+  else if (name == "lossExp")
+    ok = ParseDouble(value, config.lossExp);
+  else if (name == "TxPowerStart")
+    ok = ParseDouble(value, config.TxPowerStart);
+  else if (name == "TxPowerEnd")
+    ok = ParseDouble(value, config.TxPowerEnd);
+  else if (name == "TxPowerLevels")
+    ok = ParseDouble(value, config.TxPowerLevels);
+  else if (name == "experiment")
+    config.experiment = value;
+  else if (name == "channelWidth")
+    ok = ParseDouble(value, config.channelWidth);
+  else if (name == "strategy")
+    ok = ParseChoice(name, value, config.strategy);
+  else if (name == "runID")
+    config.runID = value;
+  else if (name == "input")
+    config.input = value;
+  else if (name == "distances")
+    ok = ParseDistances(value, config.distancesStr);
+  else if (name == "rateControl")
+    ok = ParseChoice(name, value, config.rateControl);
+  else if (name == "phyRate")
+    config.phyRate = value;
+  else if (name == "RngRun")
+    ok = ParseUnsigned(value, config.rngRun);
+  else if (name == "sampleInterval")
+    ok = ParseDouble(value, config.sampleInterval);
+  else if (name == "sampleCapacity")
+    ok = ParseUnsigned(value, config.sampleCapacity);
+  else if (name == "trafficModel")
+    ok = ParseChoice(name, value, config.trafficModel);
+  else if (name == "onTime")
+    ok = ParseDouble(value, config.onTime);
+  else if (name == "offTime")
+    ok = ParseDouble(value, config.offTime);
+  else if (name == "paretoShape")
+    ok = ParseDouble(value, config.paretoShape);
+  else if (name == "packetSizeDist")
+    ok = ParseChoice(name, value, config.packetSizeDist);
+  else if (name == "packetSizeMin")
+    ok = ParseUnsigned(value, config.packetSizeMin);
+  else if (name == "saturationWindow")
+    ok = ParseUnsigned(value, config.saturationWindow);
+  else if (name == "startJitter")
+    ok = ParseDouble(value, config.startJitter);
+  else if (name == "direction")
+    ok = ParseChoice(name, value, config.direction);
+  else if (name == "convergence")
+    ok = ParseDouble(value, config.convergence);
+  else if (name == "convergenceBatch")
+    ok = ParseDouble(value, config.convergenceBatch);
+  else if (name == "fastAssociation")
+    ok = ParseBool(value, config.fastAssociation);
+  else if (name == "output")
+    ok = ParseChoice(name, value, config.output);
+  else if (name == "apNum")
+    ok = ParseUnsigned(value, config.apNum);
+  else if (name == "layout")
+    ok = ParseChoice(name, value, config.layout);
+  else if (name == "areaWidth")
+    ok = ParseDouble(value, config.areaWidth);
+  else if (name == "areaHeight")
+    ok = ParseDouble(value, config.areaHeight);
+  else if (name == "clusterNum")
+    ok = ParseUnsigned(value, config.clusterNum);
+  else if (name == "clusterRadius")
+    ok = ParseDouble(value, config.clusterRadius);
+  else if (name == "roomSize")
+    ok = ParseDouble(value, config.roomSize);
+  else if (name == "topologySeed")
+    ok = ParseUnsigned(value, config.topologySeed);
+  else if (name == "lossMatrix")
+    ok = ParseBool(value, config.lossMatrix);
+  else if (name == "rangeLimit")
+    ok = ParseBool(value, config.rangeLimit);
+  else if (name == "rangeMargin")
+    ok = ParseDouble(value, config.rangeMargin);
+  else
+    return false;
+  if (!ok)
+  {
+    NS_LOG_ERROR("Can't parse value \"" << value << "\" of parameter " << name);
+  }
+  return ok;
+}
+
+WifiTopologyConfig GetTopologyConfig(const WifiScenarioConfig &config)
+{
+  WifiTopologyConfig topologyConfig;
+  topologyConfig.layout = config.layout;
+  topologyConfig.apNum = config.apNum;
+  topologyConfig.staNum = config.staNum;
+  topologyConfig.width = config.areaWidth;
+  topologyConfig.height = config.areaHeight;
+  topologyConfig.clusterNum = config.clusterNum;
+  topologyConfig.clusterRadius = config.clusterRadius;
+  topologyConfig.roomSize = config.roomSize;
+  topologyConfig.seed = config.topologySeed != 0 ? config.topologySeed : config.rngRun;
+  return topologyConfig;
+}
+
+bool ValidateScenarioConfig(const WifiScenarioConfig &config, std::string &error)
+{
+  const std::map<std::string, std::string> choices = {
+      {"standard", config.standard},
+      {"rateControl", config.rateControl},
+      {"strategy", config.strategy},
+      {"trafficModel", config.trafficModel},
+      {"packetSizeDist", config.packetSizeDist},
+      {"direction", config.direction},
+      {"output", config.output},
+      {"layout", config.layout},
+  };
+  std::string unknown = "";
+  for (auto &it : choices)
+  {
+    if (unknown == "" && !IsScenarioChoice(it.first, it.second))
+    {
+      unknown = it.first + ": " + it.second;
+    }
+  }
+
+  std::ostringstream out;
+  bool onOff = config.trafficModel == "onoff-exp" || config.trafficModel == "onoff-pareto";
+  std::string topologyError;
+  if (unknown != "")
+  {
+    out << "Unknown " << unknown;
+  }
+  else if (!IsDistanceList(config.distancesStr))
+  {
+    out << "Invalid distances: " << config.distancesStr;
+  }
+  else if (config.channelWidth != 20 && config.channelWidth != 40 && config.channelWidth != 80 && config.channelWidth != 160)
+  {
+    out << "Unknown channel width: " << config.channelWidth;
+  }
+  else if (onOff && (config.onTime <= 0 || config.offTime < 0 || config.paretoShape <= 1))
+  {
+    out << "Invalid on/off periods: onTime=" << config.onTime << " offTime=" << config.offTime
+        << " paretoShape=" << config.paretoShape;
+  }
+  else if (config.packetSizeDist == "uniform" && (config.packetSizeMin < 1 || config.packetSizeMin > config.packetSize))
+  {
+    out << "Invalid packetSizeMin: " << config.packetSizeMin;
+  }
+  else if (config.convergence > 0 && config.convergenceBatch <= 0)
+  {
+    out << "Invalid convergenceBatch: " << config.convergenceBatch;
+  }
+  else if (config.layout == "" && config.apNum != 1)
+  {
+    out << "More than one AP needs a layout [grid|random|clustered|floorplan]";
+  }
+  else if (config.layout != "" && !WifiTopologyGenerator::Validate(GetTopologyConfig(config), topologyError))
+  {
+    out << topologyError;
+  }
+  else if (config.lossMatrix && static_cast<uint64_t>(config.apNum) + config.staNum > PathLossMatrix::MAX_NODES)
+  {
+    out << "Too many nodes for the path loss matrix: " << static_cast<uint64_t>(config.apNum) + config.staNum
+        << ", at most " << PathLossMatrix::MAX_NODES;
+  }
+  error = out.str();
+  return error == "";
+}
+
+//------------------------------------------------------------
+//-- Saturated traffic
+//------------------------------------------------------------
+
+// Saturated senders by the receiver MAC address of their frames, fed by the traces of a MAC queue.
+// The AP's queue has the downlink senders of all the STAs, the queue of a STA its uplink sender.
+struct SaturationTraceContext
+{
+  std::map<Mac48Address, Ptr<Sender>> senders;
+};
+
+// The queue also holds management frames (e.g. ADDBA requests) for the STAs, only data counts
+static void SaturationEnqueueCallback(SaturationTraceContext *context, Ptr<const WifiMacQueueItem> item)
+{
+  const WifiMacHeader &header = item->GetHeader();
+  if (header.IsData())
+  {
+    auto it = context->senders.find(header.GetAddr1());
+    if (it != context->senders.end())
+    {
+      it->second->NotifyMacEnqueue();
+    }
+  }
+}
+
+// Also called for the packets removed from the queue without being sent, e.g. expired ones
+static void SaturationDequeueCallback(SaturationTraceContext *context, Ptr<const WifiMacQueueItem> item)
+{
+  const WifiMacHeader &header = item->GetHeader();
+  if (header.IsData())
+  {
+    auto it = context->senders.find(header.GetAddr1());
+    if (it != context->senders.end())
+    {
+      it->second->NotifyMacDequeue();
+    }
+  }
+}
+
+// The queue the data of a device goes through: best effort with QoS (n/ac/ax), the DCF queue without it
+static Ptr<WifiMacQueue> GetDataQueue(Ptr<NetDevice> device)
+{
+  Ptr<WifiMac> mac = device->GetObject<WifiNetDevice>()->GetMac();
+  BooleanValue qosSupported;
+  mac->GetAttribute("QosSupported", qosSupported);
+  PointerValue txop;
+  mac->GetAttribute(qosSupported.Get() ? "BE_Txop" : "Txop", txop);
+  return txop.Get<Txop>()->GetWifiMacQueue();
+}
+
+//------------------------------------------------------------
+//-- Traffic directions
+//------------------------------------------------------------
+
+// The calculators of the flows in one direction. The downlink keys have no prefix,
+// the same as before there was an uplink, the uplink ones start with "uplink-".
+struct DirectionStats
+{
+  std::string prefix;
+  Ptr<PacketCounterCalculator> totalAppTx;
+  Ptr<PacketCounterCalculator> totalAppRx;
+  Ptr<PacketCounterCalculator> totalMacTx;
+  Ptr<PacketCounterCalculator> totalMacRx;
+  Ptr<DelayQuantileCalculator> totalDelayQuantiles;
+  Ptr<FlowStatsCalculator> totalFlowStats;
+  Ptr<WifiPhyStats> phyStats;
+
+  // Per STA, in the order of the STAs
+  std::vector<Ptr<CounterCalculator<>>> appTxCounters;
+  std::vector<Ptr<CounterCalculator<>>> appRxCounters;
+  std::vector<Ptr<Receiver>> receivers;
+  std::vector<Ptr<DelayQuantileCalculator>> delayQuantiles;
+  std::vector<Ptr<FlowStatsCalculator>> flowStats;
+
+  // The per-STA sketches and flow stats are merged into the totals after the run
+  void MergeTotals()
+  {
+    for (auto &delayQuantileStat : delayQuantiles)
+    {
+      totalDelayQuantiles->Merge(*delayQuantileStat);
+    }
+    for (auto &flowStat : flowStats)
+    {
+      totalFlowStats->Merge(*flowStat);
+    }
+  }
+};
+
+static Ptr<PacketCounterCalculator> CreateTotalCounter(const std::string &key, DataCollector &data)
+{
+  Ptr<PacketCounterCalculator> counter = CreateObject<PacketCounterCalculator>();
+  counter->SetKey(key);
+  counter->SetContext("aggregate");
+  data.AddDataCalculator(counter);
+  return counter;
+}
+
+// Creates the aggregate calculators of a direction with staNum STAs
+static void SetupDirectionStats(DirectionStats &stats, const std::string &prefix, uint32_t staNum, DataCollector &data)
+{
+  stats.prefix = prefix;
+
+  // Delay percentiles of all the STAs
+  stats.totalDelayQuantiles = CreateObject<DelayQuantileCalculator>();
+  stats.totalDelayQuantiles->SetKey(prefix + "delay");
+  stats.totalDelayQuantiles->SetContext("aggregate");
+  data.AddDataCalculator(stats.totalDelayQuantiles);
+
+  // Jitter, reordering and loss bursts of all the STAs
+  stats.totalFlowStats = CreateObject<FlowStatsCalculator>();
+  stats.totalFlowStats->SetKey(prefix + "flow");
+  stats.totalFlowStats->SetContext("aggregate");
+  data.AddDataCalculator(stats.totalFlowStats);
+
+  // One calculator for all the STAs, it outputs node[i] and aggregate counters
+  stats.phyStats = CreateObject<WifiPhyStats>();
+  stats.phyStats->SetKey(prefix + "phy-mpdu");
+  stats.phyStats->SetContext("aggregate");
+  stats.phyStats->SetStaNum(staNum);
+  data.AddDataCalculator(stats.phyStats);
+
+  stats.totalMacTx = CreateTotalCounter(prefix + "mac-tx-frames", data);
+  stats.totalMacRx = CreateTotalCounter(prefix + "mac-rx-frames", data);
+  stats.totalAppTx = CreateTotalCounter(prefix + "sender-tx-packets", data);
+  stats.totalAppRx = CreateTotalCounter(prefix + "receiver-rx-packets", data);
+}
+
+// Creates the per-STA calculators of the flow of STA sta (node[sta + 1]) and
+// connects the aggregate app counters to its applications
+static void AddFlowStats(DirectionStats &stats, uint32_t sta, Ptr<Sender> sender, Ptr<Receiver> receiver, DataCollector &data)
+{
+  NS_LOG_INFO("Setup stats and data collection of per-user data.");
+  std::string context = "node[" + std::to_string(sta + 1) + "]";
+
+  // Create a counter to track how many frames are generated for a given
+  // WiFi User.
+  Ptr<CounterCalculator<>> appTx =
+      CreateObject<CounterCalculator<>>();
+  appTx->SetKey(stats.prefix + "sender-tx-packets");
+  appTx->SetContext(context);
+  sender->SetCounter(appTx);
+  data.AddDataCalculator(appTx);
+  stats.appTxCounters.push_back(appTx);
+
+  Ptr<CounterCalculator<>> appRx =
+      CreateObject<CounterCalculator<>>();
+  appRx->SetKey(stats.prefix + "receiver-rx-packets");
+  appRx->SetContext(context);
+  receiver->SetCounter(appRx);
+  data.AddDataCalculator(appRx);
+  stats.appRxCounters.push_back(appRx);
+  stats.receivers.push_back(receiver);
+
+  Ptr<TimeMinMaxAvgTotalCalculator> delayStat =
+      CreateObject<TimeMinMaxAvgTotalCalculator>();
+  delayStat->SetKey(stats.prefix + "delay");
+  delayStat->SetContext(context);
+  receiver->SetDelayTracker(delayStat); // nanoseconds
+  data.AddDataCalculator(delayStat);
+
+  Ptr<DelayQuantileCalculator> delayQuantileStat =
+      CreateObject<DelayQuantileCalculator>();
+  delayQuantileStat->SetKey(stats.prefix + "delay");
+  delayQuantileStat->SetContext(context);
+  receiver->SetDelayQuantiles(delayQuantileStat); // nanoseconds
+  data.AddDataCalculator(delayQuantileStat);
+  stats.delayQuantiles.push_back(delayQuantileStat);
+
+  Ptr<FlowStatsCalculator> flowStat = CreateObject<FlowStatsCalculator>();
+  flowStat->SetKey(stats.prefix + "flow");
+  flowStat->SetContext(context);
+  receiver->SetFlowStats(flowStat);
+  data.AddDataCalculator(flowStat);
+  stats.flowStats.push_back(flowStat);
+
+  // The aggregate counters are connected to the applications directly,
+  // they are the same Tx and Rx trace sources the Config paths used to match
+  sender->TraceConnect("Tx", context, MakeCallback(&PacketCounterCalculator::PacketUpdate, stats.totalAppTx));
+  receiver->TraceConnect("Rx", context, MakeCallback(&PacketCounterCalculator::PacketUpdate, stats.totalAppRx));
+}
+
+// The metrics of a direction from its calculators and the counters of the finished run
+static WifiDirectionResults GetDirectionResults(const DirectionStats &stats, const MetricStore &counters,
+                                                uint64_t packetSize, double duration)
+{
+  WifiDirectionResults results;
+  results.active = true;
+
+  uint64_t appTxCount = stats.totalAppTx->GetCount();
+  uint64_t appRxCount = stats.totalAppRx->GetCount();
+  results.appDataTXRate = (double)appTxCount * packetSize * 8.0 / (double)duration / 1000.0;
+  results.appDataRXRate = (double)appRxCount * packetSize * 8.0 / (double)duration / 1000.0;
+  results.appDataLossRatio = (double)((int64_t)appTxCount - (int64_t)appRxCount) / (double)appTxCount;
+  for (auto &appRx : stats.appRxCounters)
+  {
+    results.staAppRxRates.push_back((double)appRx->GetCount() * packetSize * 8.0 / (double)duration / 1000.0);
+  }
+
+  // if delay-average_node in the key name, then sum it into the total delay. Divide by the number of nodes later
+  double totalDelaySum = 0.0;
+  uint32_t totalDelayCount = 0;
+  for (uint32_t i = 0; i < stats.appRxCounters.size(); i++)
+  {
+    double delay;
+    if (counters.Find(stats.prefix + "delay-average", "node[" + std::to_string(i + 1) + "]", delay))
+    {
+      totalDelaySum += delay;
+      totalDelayCount++;
+    }
+  }
+  // if totalDelayCount is zero, then set avgDelay to zero
+  results.appAvgDelay = totalDelayCount > 0 ? totalDelaySum / (double)totalDelayCount * 1000 : 0.0; // Convert to ms
+
+  results.delaySketch = stats.totalDelayQuantiles->GetSketch();
+  results.appDelayP50 = results.delaySketch.GetQuantile(0.5) / 1e6; // Convert to ms
+  results.appDelayP90 = results.delaySketch.GetQuantile(0.9) / 1e6;
+  results.appDelayP99 = results.delaySketch.GetQuantile(0.99) / 1e6;
+  results.appDelayP999 = results.delaySketch.GetQuantile(0.999) / 1e6;
+  FlowStats totalFlow = stats.totalFlowStats->GetStats();
+  results.appJitter = totalFlow.GetJitter() / 1e6; // Convert to ms
+  results.appReordered = totalFlow.GetReordered();
+  results.appDuplicates = totalFlow.GetDuplicates();
+  results.appLossBursts = totalFlow.GetLossBursts();
+  results.appMaxLossBurst = totalFlow.GetMaxLossBurst();
+
+  // Payload size presented to MAC layer is APP_SIZE + UDP_HEADER_SIZE + IP_HEADER_SIZE
+  uint16_t macPayloadSize = packetSize + 8 + 20;
+  // if totalMacTx->GetCount() - totalMacRx->GetCount() < 0 then macDropCount = 0
+  int64_t macTxCount = stats.totalMacTx->GetCount();
+  int64_t macRxCount = stats.totalMacRx->GetCount();
+  int64_t totalMacLoss = macTxCount - macRxCount > 0 ? macTxCount - macRxCount : 0;
+
+  results.macDataTXRate = macTxCount * macPayloadSize * 8 / (double)duration / 1000.0;
+  results.macDataRXRate = macRxCount * macPayloadSize * 8 / (double)duration / 1000.0;
+  results.macDataLossRatio = (double)totalMacLoss / (double)macTxCount;
+
+  StaPhyCounters phyTotal = stats.phyStats->GetTotal();
+  uint64_t wifiDataTXCount = phyTotal.rxCount + phyTotal.dropCount;
+  results.avgRSS = phyTotal.rssSum / (double)phyTotal.rxCount;
+
+  results.wifiDataTXRate = (double)(phyTotal.rxBytes + phyTotal.dropBytes) * 8.0 / (double)duration / 1000.0;
+  results.wifiDataRXRate = (double)phyTotal.rxBytes * 8.0 / (double)duration / 1000.0;
+  results.wifiDataLossRatio = (double)phyTotal.dropCount / (double)wifiDataTXCount;
+  return results;
+}
+
+//------------------------------------------------------------
+//-- Fast association
+//------------------------------------------------------------
+
+// With fast association the applications are only added to their nodes once every STA is associated.
+// Node::AddApplication() initializes an application right away, so the start times count from then.
+// If some STA is still not associated at the fallback time, the traffic starts anyway.
+struct TrafficStarter
+{
+  struct PendingApp
+  {
+    Ptr<Node> node;
+    Ptr<Application> app;
+    double offset; // start time in seconds after the traffic starts
+  };
+
+  std::vector<PendingApp> apps;
+  std::vector<bool> associated;               // per STA
+  uint32_t pending = 0;                       // STAs not associated yet
+  bool started = false;
+  Time startTime;
+  double duration = 0;                        // the run stops this long after the traffic starts
+  ConvergenceMonitor *convergence = nullptr;  // started with the traffic if it's enabled
+  EventId fallback;
+
+  void Start()
+  {
+    if (started)
+    {
+      return;
+    }
+    started = true;
+    Simulator::Cancel(fallback);
+    startTime = Simulator::Now();
+    NS_LOG_INFO("Traffic starts at " << startTime.GetSeconds() << "s, " << pending << " STAs not associated");
+    for (auto &pendingApp : apps)
+    {
+      pendingApp.app->SetStartTime(Seconds(pendingApp.offset));
+      pendingApp.node->AddApplication(pendingApp.app);
+    }
+    Simulator::Stop(Seconds(duration));
+    if (convergence)
+    {
+      convergence->Start(startTime);
+    }
+  }
+
+  void NotifyAssoc(uint32_t sta)
+  {
+    if (!associated[sta])
+    {
+      associated[sta] = true;
+      if (--pending == 0)
+      {
+        Start();
+      }
+    }
+  }
+};
+
+// What the Assoc trace of a STA is bound to
+struct AssocTraceContext
+{
+  TrafficStarter *starter;
+  uint32_t sta;
+};
+
+static void AssocCallback(AssocTraceContext *context, Mac48Address bssid)
+{
+  context->starter->NotifyAssoc(context->sta);
+}
+
+//------------------------------------------------------------
+//-- Profiling
+//------------------------------------------------------------
+
+double WifiRunProfile::GetEventRate() const
+{
+  return runTime > 0 ? events / runTime : 0.0;
+}
+
+double WifiRunProfile::GetSimWallRatio() const
+{
+  return runTime > 0 ? simTime / runTime : 0.0;
+}
+
+static double ElapsedSeconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Resets the peak resident set size of the process to the current one, so the peak read at the end
+// is the one of this run and not of an earlier run in the same process (a sweep).
+// Needs Linux 4.0 or later, returns false if the peak can't be reset.
+static bool ResetPeakRss()
+{
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5";
+  clearRefs.flush();
+  return clearRefs.good();
+}
+
+// Peak resident set size in kB since the last reset (VmHWM), the peak of the process
+// if /proc can't be read, 0 if neither can
+static uint64_t GetPeakRss()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.compare(0, 6, "VmHWM:") == 0)
+    {
+      return std::stoull(line.substr(6));
+    }
+  }
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+  {
+    return 0;
+  }
+  return usage.ru_maxrss; // kB on Linux
+}
+
+//------------------------------------------------------------
+//-- WifiScenario
+//------------------------------------------------------------
+
+WifiScenario::WifiScenario(const WifiScenarioConfig &config) : m_config(config)
+{
+}
+
+const WifiScenarioConfig &
+WifiScenario::GetConfig() const
+{
+  return m_config;
+}
+
+WifiScenarioResults WifiScenario::Run()
+{
+  // Local copies, the placement code below changes some of them
+  double distance = m_config.distance;
+  double duration = m_config.duration;
+  uint64_t desiredDataRate = m_config.desiredDataRate;
+  uint64_t packetSize = m_config.packetSize;
+  uint64_t packetNum = m_config.packetNum;
+  bool verbose = m_config.verbose;
+  bool pcap = m_config.pcap;
+  uint32_t staNum = m_config.staNum;
+  bool debug = m_config.debug;
+  std::string standard = m_config.standard;
+  double lossExp = m_config.lossExp;
+  double TxPowerStart = m_config.TxPowerStart;
+  double TxPowerEnd = m_config.TxPowerEnd;
+  double TxPowerLevels = m_config.TxPowerLevels;
+  std::string experiment = m_config.experiment;
+  double channelWidth = m_config.channelWidth;
+  std::string strategy = m_config.strategy;
+  std::string runID = m_config.runID;
+  std::string input = m_config.input;
+  std::string distancesStr = m_config.distancesStr;
+  std::string rateControl = m_config.rateControl;
+  std::string phyRate = m_config.phyRate;
+
+  WifiScenarioResults results;
+  std::string error;
+  if (!ValidateScenarioConfig(m_config, error))
+  {
+    std::cout << "Invalid scenario: " << error << std::endl;
+    results.failed = true;
+    results.error = error;
+    return results;
+  }
+  WifiRunProfile &profile = results.profile;
+  profile.peakRssPerRun = ResetPeakRss();
+  auto setupStart = std::chrono::steady_clock::now();
+  auto phaseStart = setupStart;
+  auto endSetupPhase = [&](const std::string &name) {
+    auto now = std::chrono::steady_clock::now();
+    profile.setupPhases.push_back(std::make_pair(name, std::chrono::duration<double>(now - phaseStart).count()));
+    phaseStart = now;
+  };
+
+  // Several scenarios may be run in one process. The simulator is destroyed after every run,
+  // but the IPv4 address generator is global and would report the addresses of
+  // the previous run as collisions.
+  Ipv4AddressGenerator::Reset();
+  RngSeedManager::SetRun(m_config.rngRun);
+
+  // This delay is required for the AP to send beacons to the STAs and for the STAs to associate with the AP
+  // Application start time is delayed by this amount. With fast association it's only the fallback.
+  double start_delay = 5.0;
+  bool fastAssociation = m_config.fastAssociation;
+  double simTime = duration + start_delay;
+
+  // Set up logging levels
+  if (verbose)
+  {
+    LogComponentEnable("ee500_WiFi_Sim", LOG_LEVEL_INFO);
+  }
+
+  if (debug)
+  {
+    LogComponentEnable("SenderReceiver", LOG_LEVEL_ALL);
+    LogComponentEnable("ee500_WiFi_Sim", LOG_LEVEL_ALL);
+  }
+
+  //------------------------------------------------------------
+  //-- Generate topology
+  //------------------------------------------------------------
+  // With a layout the APs and STAs are placed by the topology generator and every STA associates
+  // with the nearest AP. Without one there is a single AP at the origin and the strategy places the STAs.
+  uint32_t apNum = m_config.apNum;
+  bool generated = m_config.layout != "";
+  WifiTopology topology;
+  if (generated)
+  {
+    if (!WifiTopologyGenerator::Generate(GetTopologyConfig(m_config), topology))
+    {
+      results.failed = true;
+      results.error = "Can't generate the topology";
+      return results;
+    }
+  }
+  // The AP of every STA, by STA ordinal
+  std::vector<uint32_t> staAps = generated ? topology.staAps : std::vector<uint32_t>(staNum, 0);
+
+  //------------------------------------------------------------
+  //-- Create nodes
+  //------------------------------------------------------------
+  NS_LOG_INFO("Create nodes.");
+  NodeContainer nodes;
+  nodes.Create(apNum + staNum);
+
+  // The APs come first, node 0 is the only AP unless there's a layout
+  NodeContainer apNodes;
+  NodeContainer staNodes;
+  for (uint32_t i = 0; i < nodes.GetN(); ++i)
+  {
+    if (i < apNum)
+    {
+      apNodes.Add(nodes.Get(i));
+    }
+    else
+    {
+      staNodes.Add(nodes.Get(i));
+    }
+  }
+  NS_LOG_INFO("Number of nodes created: " << nodes.GetN());
+  endSetupPhase("nodes");
+
+  //------------------------------------------------------------
+  //-- Setup WiFi
+  //------------------------------------------------------------
+  NS_LOG_INFO("Setup WiFi.");
+
+  // Set the WiFi standard
+  WifiHelper wifi;
+  if (standard == "b")
+  {
+    wifi.SetStandard(WIFI_PHY_STANDARD_80211b);
+    std::cout << "Standard: 802.11b" << std::endl;
+  }
+  else if (standard == "a")
+  {
+    wifi.SetStandard(WIFI_PHY_STANDARD_80211a);
+    std::cout << "Standard: 802.11a" << std::endl;
+  }
+  else if (standard == "g")
+  {
+    wifi.SetStandard(WIFI_PHY_STANDARD_80211g);
+    std::cout << "Standard: 802.11g" << std::endl;
+  }
+  else if (standard == "n")
+  {
+    wifi.SetStandard(WIFI_PHY_STANDARD_80211n_5GHZ);
+    std::cout << "Standard: 802.11n in 5GHZ" << std::endl;
+  }
+  else if (standard == "n24")
+  {
+    wifi.SetStandard(WIFI_PHY_STANDARD_80211n_2_4GHZ);
+    std::cout << "Standard: 802.11n in 2.4GHZ" << std::endl;
+  }
+  else if (standard == "ac")
+  {
+    wifi.SetStandard(WIFI_PHY_STANDARD_80211ac);
+    std::cout << "Standard: 802.11ac" << std::endl;
+  }
+  else if (standard == "ax")
+  {
+    wifi.SetStandard(WIFI_PHY_STANDARD_80211ax_5GHZ);
+    std::cout << "Standard: 802.11ax in 5GHZ" << std::endl;
+  }
+  else if (standard == "ax24")
+  {
+    wifi.SetStandard(WIFI_PHY_STANDARD_80211ax_2_4GHZ);
+    std::cout << "Standard: 802.11ax in 2.4GHZ" << std::endl;
+  }
+
+  // Set the frequency based on the WiFi standard, 2.4 or 5.15 GHz
+  double frequency = WifiAnalyticModel::GetFrequency(standard);
+  double refLoss = WifiAnalyticModel::GetReferenceLoss(frequency); // Reference loss at 1 meter
+
+  if (verbose)
+  {
+    // print out the reference loss and the frequency
+    std::cout << "Reference loss at 1 meter for " << frequency / 1e9 << " GHz is " << refLoss << " dB" << std::endl;
+  }
+
+  // Set the rate control algorithm
+  if (rateControl == "minstrel")
+  {
+    wifi.SetRemoteStationManager("ns3::MinstrelWifiManager");
+    std::cout << "Rate control: Minstrel" << std::endl;
+  }
+  else if (rateControl == "minstrelht")
+  {
+    wifi.SetRemoteStationManager("ns3::MinstrelHtWifiManager");
+    std::cout << "Rate control: MinstrelHT" << std::endl;
+  }
+  else if (rateControl == "constant")
+  {
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode", StringValue(phyRate));
+    std::cout << "Rate control: Constant"
+              << " at " << phyRate << std::endl;
+  }
+
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+  // With the loss matrix the same log-distance losses are computed once the nodes are placed.
+  // With the range limit every PHY has a channel of its own, all of them share the loss model.
+  Ptr<PathLossMatrix> lossMatrix;
+  Ptr<PropagationLossModel> lossModel;
+  if (m_config.lossMatrix)
+  {
+    lossMatrix = CreateObject<PathLossMatrix>();
+    lossMatrix->SetLogDistance(lossExp, refLoss, 1.0);
+    lossModel = lossMatrix;
+  }
+  else if (m_config.rangeLimit)
+  {
+    lossModel = CreateObject<LogDistancePropagationLossModel>();
+    lossModel->SetAttribute("Exponent", DoubleValue(lossExp));
+    lossModel->SetAttribute("ReferenceLoss", DoubleValue(refLoss));
+  }
+  else
+  {
+    wifiChannel.AddPropagationLoss("ns3::LogDistancePropagationLossModel",
+                                   "Exponent", DoubleValue(lossExp),
+                                   "ReferenceLoss", DoubleValue(refLoss));
+  }
+  RangeLimitedChannels rangeChannels(wifiChannel, lossModel);
+  rangeChannels.SetLogDistance(lossExp, refLoss, 1.0);
+
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default();
+  if (!m_config.rangeLimit)
+  {
+    Ptr<YansWifiChannel> channel = wifiChannel.Create();
+    if (lossModel)
+    {
+      channel->SetPropagationLossModel(lossModel);
+    }
+    wifiPhy.SetChannel(channel);
+  }
+  wifiPhy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
+
+  // Set the transmit power or leave at default if -100
+  std::cout << "Number of power levels: " << TxPowerLevels << std::endl;
+  if (TxPowerEnd != -100)
+  {
+    // if TxPowerLevels is 1, then we need to set the TxPowerStart and TxPowerEnd to the same value
+
+    if (TxPowerLevels == 1)
+    {
+      TxPowerStart = TxPowerEnd;
+      wifiPhy.Set("TxPowerStart", DoubleValue(TxPowerStart));
+      wifiPhy.Set("TxPowerEnd", DoubleValue(TxPowerEnd));
+    }
+    else
+    {
+      wifiPhy.Set("TxPowerStart", DoubleValue(TxPowerStart));
+      wifiPhy.Set("TxPowerEnd", DoubleValue(TxPowerEnd));
+    }
+    std::cout << "TxPowerStart: " << TxPowerStart << " dBm" << std::endl;
+    std::cout << "TxPowerEnd: " << TxPowerEnd << " dBm" << std::endl;
+  }
+  else
+  {
+    std::cout << "TxPower levels not set, using default" << std::endl;
+  }
+
+  // Set the channel width
+  if (channelWidth == 20)
+  {
+    wifiPhy.Set("ChannelWidth", UintegerValue(20));
+    std::cout << "Channel width: 20 MHz, default" << std::endl;
+  }
+  else if (channelWidth == 40)
+  {
+    wifiPhy.Set("ChannelWidth", UintegerValue(40));
+    std::cout << "Channel width: 40 MHz" << std::endl;
+  }
+  else if (channelWidth == 80)
+  {
+    wifiPhy.Set("ChannelWidth", UintegerValue(80));
+    std::cout << "Channel width: 80 MHz" << std::endl;
+  }
+  else if (channelWidth == 160)
+  {
+    wifiPhy.Set("ChannelWidth", UintegerValue(160));
+    std::cout << "Channel width: 160 MHz" << std::endl;
+  }
+
+  // Every AP has an SSID of its own, so a STA can only associate with the AP it was given.
+  // A single AP keeps the original SSID.
+  auto getSsid = [apNum](uint32_t ap) {
+    return Ssid(apNum == 1 ? std::string("ee500_wifi_sim") : "ee500_wifi_sim-" + std::to_string(ap));
+  };
+  WifiMacHelper wifiMac;
+
+  // Set up the APs
+  // Fast association: 10 beacons a second instead of about one, and the STAs probe instead of waiting for them
+  NetDeviceContainer apDevice;
+  for (uint32_t k = 0; k < apNum; ++k)
+  {
+    wifiMac.SetType("ns3::ApWifiMac",
+                    "Ssid", SsidValue(getSsid(k)),
+                    "BeaconGeneration", BooleanValue(true),
+                    "BeaconInterval", TimeValue(MicroSeconds(fastAssociation ? 102400 : 1024000))); // 0.1024 or 1.024 seconds
+    if (m_config.rangeLimit)
+    {
+      wifiPhy.SetChannel(rangeChannels.Create());
+    }
+    apDevice.Add(wifi.Install(wifiPhy, wifiMac, apNodes.Get(k)));
+  }
+
+  // Set up the STAs
+  NetDeviceContainer staDevices;
+  for (uint32_t i = 0; i < staNum; ++i)
+  {
+    wifiMac.SetType("ns3::StaWifiMac",
+                    "Ssid", SsidValue(getSsid(staAps[i])),
+                    "ActiveProbing", BooleanValue(fastAssociation));
+    if (m_config.rangeLimit)
+    {
+      wifiPhy.SetChannel(rangeChannels.Create());
+    }
+    staDevices.Add(wifi.Install(wifiPhy, wifiMac, staNodes.Get(i)));
+  }
+
+  if (verbose)
+  {
+    // Print out the channel number, frequency, and tx power of each node
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+      Ptr<WifiPhy> phy = nodes.Get(i)->GetDevice(0)->GetObject<WifiNetDevice>()->GetPhy();
+      uint16_t channelNumber = phy->GetChannelNumber();
+      double frequency = phy->GetFrequency();
+      double txPowerStart = phy->GetTxPowerStart();
+      double txPowerEnd = phy->GetTxPowerEnd();
+
+      std::cout << "Node " << i << " Channel Number: " << channelNumber
+                << " Frequency: " << frequency << " MHz" << std::endl;
+      std::cout << "Node " << i << " TxPowerStart: " << txPowerStart << " dBm"
+                << " TxPowerEnd: " << txPowerEnd << " dBm" << std::endl;
+    }
+  }
+
+  if (pcap)
+  {
+    wifiPhy.EnablePcapAll("all_stations");
+  }
+
+  endSetupPhase("wifi");
+
+  //------------------------------------------------------------
+  //-- Setup physical layout
+  //------------------------------------------------------------
+  NS_LOG_INFO("Create mobility model and place nodes.");
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
+
+  // Print out the number of APs, STAs and the name of the strategy
+  std::cout << "Number of APs: " << apNodes.GetN() << std::endl;
+  std::cout << "Number of STAs: " << staNodes.GetN() << std::endl;
+  std::cout << "Strategy: " << strategy << std::endl;
+
+  if (generated)
+  {
+    // Same order as the nodes, the APs first
+    std::cout << "Layout: " << m_config.layout << " over " << m_config.areaWidth << " x " << m_config.areaHeight << " m" << std::endl;
+    for (auto &position : topology.apPositions)
+    {
+      positionAlloc->Add(position);
+    }
+    for (auto &position : topology.staPositions)
+    {
+      positionAlloc->Add(position);
+    }
+  }
+  else
+  {
+    positionAlloc->Add(Vector(0.0, 0.0, 0.0)); // AP
+
+    std::vector<double> distances;
+    // put default distance in the vector
+    distances.push_back(distance);
+    if (distancesStr != "")
+    {
+      std::stringstream ss(distancesStr);
+      std::string item;
+      std::cout << "Distances (meters): ";
+      while (std::getline(ss, item, ','))
+      {
+        double distance = std::stod(item); // convert string to double
+        distances.push_back(distance);
+        std::cout << distance << " ";
+      }
+      std::cout << std::endl;
+      std::cout << "Default distance (meters): " << distances[0] << std::endl;
+    }
+    else
+    {
+      std::cout << "Distance (meters): " << distance << std::endl;
+    }
+
+    if (strategy == "wifi-radial")
+    {
+      // Place STAs in a circle around the AP
+      double theta = 2.0 * M_PI / staNodes.GetN();
+
+      for (uint32_t i = 1; i < nodes.GetN(); ++i) // STAs
+      {
+        // if distances contains the distance for this STA, use it
+        // else use the default distance in element 0
+        if (i < distances.size())
+        {
+          distance = distances[i];
+        }
+        else
+        {
+          distance = distances[0];
+        }
+        double angle = i * theta;
+        double x = distance * cos(angle); // x = r * cos(theta)
+        double y = distance * sin(angle); // y = r * sin(theta)
+        // round to 2 decimal places
+        positionAlloc->Add(Vector(round(x * 100) / 100, round(y * 100) / 100, 0.0));
+      }
+    }
+    else
+    {
+      // Place STAs in a line along the x-axis
+      for (uint32_t i = 1; i < nodes.GetN(); ++i) // STAs
+      {
+        // if distances contains the distance for this STA, use it
+        // else use the default distance in element 0
+        if (i < distances.size())
+        {
+          distance = distances[i];
+        }
+        else
+        {
+          distance = distances[0];
+        }
+        positionAlloc->Add(Vector(distance, 0.0, 0.0));
+      }
+    }
+  }
+  mobility.SetPositionAllocator(positionAlloc);
+  mobility.Install(nodes);
+
+  // Nothing moves from here on
+  if (lossMatrix && !lossMatrix->Build(nodes))
+  {
+    Simulator::Destroy();
+    results.failed = true;
+    results.error = "Can't build the path loss matrix";
+    return results;
+  }
+  if (m_config.rangeLimit)
+  {
+    NetDeviceContainer wifiDevices;
+    wifiDevices.Add(apDevice);
+    wifiDevices.Add(staDevices);
+    if (!rangeChannels.Connect(wifiDevices, m_config.rangeMargin))
+    {
+      Simulator::Destroy();
+      results.failed = true;
+      results.error = "Can't connect the range limited channels";
+      return results;
+    }
+    std::cout << "Range limit: " << rangeChannels.GetLinks() << " of " << rangeChannels.GetPairs()
+              << " links within " << m_config.rangeMargin << " dB of the RxSensitivity" << std::endl;
+  }
+
+  if (verbose)
+  {
+    // Print out the positions of the nodes
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+      Ptr<MobilityModel> mobility = nodes.Get(i)->GetObject<MobilityModel>();
+      Vector pos = mobility->GetPosition();
+      std::cout << "Node " << i << " position: " << pos.x << ", " << pos.y << ", " << pos.z << std::endl;
+    }
+  }
+
+  endSetupPhase("layout");
+
+  //------------------------------------------------------------
+  //-- Setup internet stack
+  //------------------------------------------------------------
+  NS_LOG_INFO("Setup internet stack and assign IP addresses.");
+  InternetStackHelper internet;
+  internet.Install(nodes);
+
+  Ipv4AddressHelper ipv4Addr;
+  // A /24 holds 253 nodes besides the AP, larger topologies get a /16
+  ipv4Addr.SetBase("192.168.0.0", nodes.GetN() < 254 ? "255.255.255.0" : "255.255.0.0");
+
+  Ipv4InterfaceContainer apIfaces = ipv4Addr.Assign(apDevice);
+  Ipv4InterfaceContainer staIfaces = ipv4Addr.Assign(staDevices);
+
+  if (verbose)
+  {
+    // Print out the IP addresses of the nodes
+    for (uint32_t i = 0; i < apIfaces.GetN(); i++)
+    {
+      std::cout << "AP Node " << i << " IP: " << apIfaces.GetAddress(i) << std::endl;
+    }
+
+    for (uint32_t i = 0; i < staIfaces.GetN(); i++)
+    {
+      std::cout << "STA Node " << i << " IP: " << staIfaces.GetAddress(i) << std::endl;
+    }
+  }
+
+  endSetupPhase("internet");
+
+  //------------------------------------------------------------
+  //-- Traffic models
+  //------------------------------------------------------------
+  NS_LOG_INFO("Setup traffic models.");
+  // Mean packet interval in seconds for the desired data rate
+  double interval = static_cast<double>(packetSize * 8) / (desiredDataRate * 1000);
+  std::string intervalStr, onTimeStr, offTimeStr, packetSizesStr;
+  const std::string &trafficModel = m_config.trafficModel;
+  if (trafficModel == "onoff-exp" || trafficModel == "onoff-pareto")
+  {
+    // Packets are sent only during the on periods, faster, so the mean data rate stays the desired one
+    interval *= m_config.onTime / (m_config.onTime + m_config.offTime);
+  }
+  if (trafficModel == "cbr" || trafficModel == "saturated")
+  {
+    intervalStr = "ns3::ConstantRandomVariable[Constant=" + std::to_string(interval) + "]";
+  }
+  else if (trafficModel == "poisson")
+  {
+    intervalStr = "ns3::ExponentialRandomVariable[Mean=" + std::to_string(interval) + "]";
+  }
+  else if (trafficModel == "onoff-exp")
+  {
+    intervalStr = "ns3::ConstantRandomVariable[Constant=" + std::to_string(interval) + "]";
+    onTimeStr = "ns3::ExponentialRandomVariable[Mean=" + std::to_string(m_config.onTime) + "]";
+    offTimeStr = "ns3::ExponentialRandomVariable[Mean=" + std::to_string(m_config.offTime) + "]";
+  }
+  else if (trafficModel == "onoff-pareto")
+  {
+    // The Mean attribute of ParetoRandomVariable is deprecated and ignored in ns-3.30, the distribution
+    // is set by Scale (the smallest value), and the mean is Scale * Shape / (Shape - 1)
+    double shape = m_config.paretoShape;
+    std::string shapeStr = std::to_string(shape);
+    intervalStr = "ns3::ConstantRandomVariable[Constant=" + std::to_string(interval) + "]";
+    onTimeStr = "ns3::ParetoRandomVariable[Scale=" + std::to_string(m_config.onTime * (shape - 1) / shape) + "|Shape=" + shapeStr + "]";
+    offTimeStr = "ns3::ParetoRandomVariable[Scale=" + std::to_string(m_config.offTime * (shape - 1) / shape) + "|Shape=" + shapeStr + "]";
+  }
+
+  const std::string &packetSizeDist = m_config.packetSizeDist;
+  if (packetSizeDist == "uniform")
+  {
+    // Symmetric around packetSize, GetInteger() draws from [Min, Max] with both ends included
+    packetSizesStr = "ns3::UniformRandomVariable[Min=" + std::to_string(m_config.packetSizeMin) +
+                     "|Max=" + std::to_string(2 * packetSize - m_config.packetSizeMin) + "]";
+  }
+  else if (packetSizeDist == "exponential")
+  {
+    // Bounded by the largest UDP payload
+    packetSizesStr = "ns3::ExponentialRandomVariable[Mean=" + std::to_string(packetSize) + "|Bound=65507]";
+  }
+
+  const std::string &direction = m_config.direction;
+  bool downlink = direction != "uplink";
+  bool uplink = direction != "downlink";
+
+  // Saturated senders keep a window of packets in the MAC queue of their node instead of following the interval.
+  // By default the downlink windows of all the STAs of an AP share its queue, but never more than an A-MPDU of 64 packets each.
+  // An uplink flow has the queue of its STA to itself.
+  bool saturated = trafficModel == "saturated";
+  uint32_t saturationWindow = m_config.saturationWindow;
+  uint32_t uplinkSaturationWindow = m_config.saturationWindow;
+  if (saturated && saturationWindow == 0)
+  {
+    // The queues are all the same size, the window fits the AP with the most STAs
+    std::vector<uint32_t> apStaNums(apNum, 0);
+    for (uint32_t ap : staAps)
+    {
+      apStaNums[ap]++;
+    }
+    uint32_t maxStaNum = *std::max_element(apStaNums.begin(), apStaNums.end());
+    uint32_t queueSize = GetDataQueue(apDevice.Get(0))->GetMaxSize().GetValue();
+    saturationWindow = std::max<uint32_t>(1, std::min<uint32_t>(64, queueSize / (maxStaNum + 1)));
+    uplinkSaturationWindow = std::max<uint32_t>(1, std::min<uint32_t>(64, queueSize));
+  }
+  // One per AP for the downlink, sized up front so the pointers bound into the callbacks stay valid
+  std::vector<SaturationTraceContext> saturationContexts(apNum);
+  // One per STA for the uplink, sized up front so the pointers bound into the callbacks stay valid
+  std::vector<SaturationTraceContext> uplinkSaturationContexts(uplink ? staNum : 0);
+
+  // Every flow starts at a random offset, so the STAs' arrivals aren't synchronised
+  Ptr<UniformRandomVariable> startOffset = CreateObject<UniformRandomVariable>();
+  startOffset->SetAttribute("Min", DoubleValue(0));
+  startOffset->SetAttribute("Max", DoubleValue(m_config.startJitter * interval));
+
+  //------------------------------------------------------------
+  //-- Create data collector and setup metadata
+  //------------------------------------------------------------
+  NS_LOG_INFO("Create data collector and setup metadata.");
+  DataCollector data;
+  data.DescribeRun(experiment, strategy, input, runID);
+  data.AddMetadata("distance", std::to_string(distance));
+  data.AddMetadata("simTime", std::to_string(simTime));
+  data.AddMetadata("desiredDataRate", std::to_string(desiredDataRate));
+  data.AddMetadata("packetSize", std::to_string(packetSize));
+  data.AddMetadata("packetNum", std::to_string(packetNum));
+  data.AddMetadata("staNum", std::to_string(staNum));
+  data.AddMetadata("standard", standard);
+  data.AddMetadata("lossExp", std::to_string(lossExp));
+  data.AddMetadata("lossMatrix", m_config.lossMatrix ? "true" : "false");
+  data.AddMetadata("rangeLimit", m_config.rangeLimit ? "true" : "false");
+  data.AddMetadata("rangeMargin", std::to_string(m_config.rangeMargin));
+  data.AddMetadata("channelWidth", std::to_string(channelWidth));
+  data.AddMetadata("rateControl", rateControl);
+  data.AddMetadata("distances", distancesStr);
+  data.AddMetadata("apNum", std::to_string(apNum));
+  if (generated)
+  {
+    data.AddMetadata("layout", m_config.layout);
+    data.AddMetadata("areaWidth", std::to_string(m_config.areaWidth));
+    data.AddMetadata("areaHeight", std::to_string(m_config.areaHeight));
+    data.AddMetadata("topologySeed", std::to_string(m_config.topologySeed != 0 ? m_config.topologySeed : m_config.rngRun));
+    if (m_config.layout == "clustered")
+    {
+      data.AddMetadata("clusterNum", std::to_string(m_config.clusterNum > 0 ? m_config.clusterNum : apNum));
+      data.AddMetadata("clusterRadius", std::to_string(m_config.clusterRadius));
+    }
+    if (m_config.layout == "floorplan")
+    {
+      data.AddMetadata("roomSize", std::to_string(m_config.roomSize));
+    }
+  }
+
+  if (TxPowerStart != -100 && TxPowerEnd != -100)
+  {
+    data.AddMetadata("TxPowerStart", std::to_string(TxPowerStart));
+    data.AddMetadata("TxPowerEnd", std::to_string(TxPowerEnd));
+    data.AddMetadata("TxPowerLevels", std::to_string(TxPowerLevels));
+  }
+  else
+  {
+    data.AddMetadata("TxPowerStart", "default");
+    data.AddMetadata("TxPowerEnd", "default");
+    data.AddMetadata("TxPowerLevels", "default");
+  }
+
+  if (rateControl == "constant")
+  {
+    data.AddMetadata("phyRate", phyRate);
+  }
+  else
+  {
+    data.AddMetadata("phyRate", "dynamic");
+  }
+  data.AddMetadata("trafficModel", trafficModel);
+  if (!onTimeStr.empty())
+  {
+    data.AddMetadata("onTime", std::to_string(m_config.onTime));
+    data.AddMetadata("offTime", std::to_string(m_config.offTime));
+  }
+  if (trafficModel == "onoff-pareto")
+  {
+    data.AddMetadata("paretoShape", std::to_string(m_config.paretoShape));
+  }
+  data.AddMetadata("direction", direction);
+  if (saturated && downlink)
+  {
+    data.AddMetadata("saturationWindow", std::to_string(saturationWindow));
+  }
+  if (saturated && uplink)
+  {
+    data.AddMetadata("uplinkSaturationWindow", std::to_string(uplinkSaturationWindow));
+  }
+  data.AddMetadata("packetSizeDist", packetSizeDist);
+  if (packetSizeDist == "uniform")
+  {
+    data.AddMetadata("packetSizeMin", std::to_string(m_config.packetSizeMin));
+  }
+  data.AddMetadata("startJitter", std::to_string(m_config.startJitter));
+  data.AddMetadata("fastAssociation", fastAssociation ? "true" : "false");
+  data.AddMetadata("sampleInterval", std::to_string(m_config.sampleInterval));
+  if (m_config.convergence > 0)
+  {
+    data.AddMetadata("convergence", std::to_string(m_config.convergence));
+    data.AddMetadata("convergenceBatch", std::to_string(m_config.convergenceBatch));
+    data.AddMetadata("maxDuration", std::to_string(duration));
+  }
+
+  // Time series of the counters, sampled while the simulation runs
+  WifiSampler sampler;
+  if (m_config.sampleInterval > 0)
+  {
+    // Enough samples for the whole run unless the capacity is given
+    uint32_t capacity = m_config.sampleCapacity;
+    if (capacity == 0)
+    {
+      capacity = static_cast<uint32_t>(simTime / m_config.sampleInterval) + 2;
+    }
+    sampler.Setup(Seconds(m_config.sampleInterval), capacity);
+    // With several APs the AP row is the first one
+    sampler.SetAp(apDevice.Get(0)->GetObject<WifiNetDevice>()->GetMac());
+  }
+
+  endSetupPhase("collector");
+
+  //------------------------------------------------------------
+  //-- Create traffic between APs and WiFi Users
+  //------------------------------------------------------------
+
+  // The AP addresses are resolved once here instead of in every callback
+  std::vector<Mac48Address> apMacs;
+  for (uint32_t k = 0; k < apNum; ++k)
+  {
+    apMacs.push_back(Mac48Address::ConvertFrom(apDevice.Get(k)->GetAddress()));
+  }
+
+  // Calculators of every direction that has flows, the uplink keys start with "uplink-"
+  DirectionStats downlinkStats;
+  DirectionStats uplinkStats;
+  if (downlink)
+  {
+    SetupDirectionStats(downlinkStats, "", staDevices.GetN(), data);
+  }
+  if (uplink)
+  {
+    SetupDirectionStats(uplinkStats, "uplink-", staDevices.GetN(), data);
+  }
+
+  // Without fast association the applications start start_delay after the beginning of the run,
+  // with it they wait in trafficStarter for the STAs to associate
+  TrafficStarter trafficStarter;
+  auto addApplication = [&](Ptr<Node> node, Ptr<Application> app, double offset) {
+    if (fastAssociation)
+    {
+      trafficStarter.apps.push_back({node, app, offset});
+    }
+    else
+    {
+      node->AddApplication(app);
+      app->SetStartTime(Seconds(start_delay + offset));
+    }
+  };
+
+  // The flows of both directions follow the same traffic model
+  auto createSender = [&](Ipv4Address destination, uint32_t port, uint32_t window) {
+    Ptr<Sender> sender = CreateObject<Sender>();
+    sender->SetAttribute("Interval", StringValue(intervalStr));
+    sender->SetAttribute("PacketSize", UintegerValue(packetSize)); // bytes
+    if (!packetSizesStr.empty())
+    {
+      sender->SetAttribute("PacketSizes", StringValue(packetSizesStr));
+    }
+    if (!onTimeStr.empty())
+    {
+      sender->SetAttribute("OnTime", StringValue(onTimeStr));
+      sender->SetAttribute("OffTime", StringValue(offTimeStr));
+    }
+    if (saturated)
+    {
+      sender->SetAttribute("Saturated", BooleanValue(true));
+      sender->SetAttribute("SaturationWindow", UintegerValue(window));
+    }
+    sender->SetAttribute("NumPackets", UintegerValue(packetNum));
+    sender->SetAttribute("Destination", Ipv4AddressValue(destination));
+    sender->SetAttribute("Port", UintegerValue(port));
+    return sender;
+  };
+
+  // Iterate over WiFi Users to setup source/sink applications for each AP-User pair
+
+  for (uint32_t i = 0; i < staNodes.GetN(); ++i)
+  {
+    NS_LOG_INFO("Create traffic source and sink.");
+
+    Ptr<Node> staNode = staNodes.Get(i);
+    Ptr<WifiMac> staWifiMac = staDevices.Get(i)->GetObject<WifiNetDevice>()->GetMac();
+    Mac48Address staMac = Mac48Address::ConvertFrom(staDevices.Get(i)->GetAddress());
+    // The flows of the STA go to and from its own AP
+    uint32_t ap = staAps[i];
+    Ptr<Node> apNode = apNodes.Get(ap);
+    // The time series follow the downlink flows, or the uplink ones if there are no others
+    Ptr<Receiver> sampledReceiver;
+
+    if (downlink)
+    {
+      // Destination address and listening port on the WiFi User
+      Ptr<Sender> sender = createSender(staIfaces.GetAddress(i), 1000 + i, saturationWindow);
+      addApplication(apNode, sender, startOffset->GetValue());
+      if (saturated)
+      {
+        saturationContexts[ap].senders[staMac] = sender;
+      }
+
+      Ptr<Receiver> receiver = CreateObject<Receiver>();
+      receiver->SetAttribute("Port", UintegerValue(1000 + i)); // Listening port on the WiFi User
+      addApplication(staNode, receiver, 0);
+
+      AddFlowStats(downlinkStats, i, sender, receiver, data);
+      sampledReceiver = receiver;
+    }
+
+    if (uplink)
+    {
+      // The AP listens on the same port numbers as the STAs, there is one port per STA
+      Ptr<Sender> sender = createSender(apIfaces.GetAddress(ap), 1000 + i, uplinkSaturationWindow);
+      addApplication(staNode, sender, startOffset->GetValue());
+      if (saturated)
+      {
+        // All the uplink frames of a STA go to the AP, each STA has a queue of its own
+        SaturationTraceContext *context = &uplinkSaturationContexts[i];
+        context->senders[apMacs[ap]] = sender;
+        Ptr<WifiMacQueue> staDataQueue = GetDataQueue(staDevices.Get(i));
+        staDataQueue->TraceConnectWithoutContext("Enqueue", MakeBoundCallback(&SaturationEnqueueCallback, context));
+        staDataQueue->TraceConnectWithoutContext("Dequeue", MakeBoundCallback(&SaturationDequeueCallback, context));
+      }
+
+      Ptr<Receiver> receiver = CreateObject<Receiver>();
+      receiver->SetAttribute("Port", UintegerValue(1000 + i)); // Listening port on the AP
+      addApplication(apNode, receiver, 0);
+
+      AddFlowStats(uplinkStats, i, sender, receiver, data);
+      if (!downlink)
+      {
+        sampledReceiver = receiver;
+      }
+    }
+
+    if (m_config.sampleInterval > 0)
+    {
+      DirectionStats &sampled = downlink ? downlinkStats : uplinkStats;
+      sampler.AddStation(sampled.appTxCounters[i], sampled.appRxCounters[i], sampledReceiver, staWifiMac);
+    }
+  }
+
+  for (uint32_t k = 0; saturated && downlink && k < apNum; ++k)
+  {
+    Ptr<WifiMacQueue> apDataQueue = GetDataQueue(apDevice.Get(k));
+    apDataQueue->TraceConnectWithoutContext("Enqueue", MakeBoundCallback(&SaturationEnqueueCallback, &saturationContexts[k]));
+    apDataQueue->TraceConnectWithoutContext("Dequeue", MakeBoundCallback(&SaturationDequeueCallback, &saturationContexts[k]));
+  }
+
+  endSetupPhase("applications");
+
+  //------------------------------------------------------------
+  //-- Setup stats and data collection of WiFi Phy data
+  //------------------------------------------------------------
+  NS_LOG_INFO("Setup stats and data collection of per-station data.");
+
+  // One trace context per STA, sized up front so the pointers bound into the callbacks stay valid
+  std::vector<StaTraceContext> staTraceContexts(downlink ? staDevices.GetN() : 0);
+
+  // The downlink MPDUs are counted at the STAs they are sent to
+  for (uint32_t i = 0; i < staTraceContexts.size(); ++i)
+  {
+    // GetPhy() returns the WifiPhy object for the NetDevice
+    Ptr<WifiNetDevice> wifiDevice = staDevices.Get(i)->GetObject<WifiNetDevice>();
+    Ptr<WifiPhy> phy = wifiDevice->GetPhy();
+    StaTraceContext *context = &staTraceContexts[i];
+    context->staMac = Mac48Address::ConvertFrom(wifiDevice->GetAddress());
+    context->apMac = apMacs[staAps[i]];
+    context->staIndex = i;
+    context->phyStats = PeekPointer(downlinkStats.phyStats);
+    phy->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&RxDropCallback, context));
+    phy->TraceConnectWithoutContext("MonitorSnifferRx", MakeBoundCallback(&MonitorSniffRxCallback, context));
+  }
+
+  // The uplink MPDUs of the STAs are counted at their AP, the sender tells the STA
+  std::vector<ApTraceContext> apTraceContexts(uplink ? apNum : 0);
+  for (uint32_t k = 0; k < apTraceContexts.size(); ++k)
+  {
+    apTraceContexts[k].apMac = apMacs[k];
+    apTraceContexts[k].phyStats = PeekPointer(uplinkStats.phyStats);
+  }
+  for (uint32_t i = 0; uplink && i < staDevices.GetN(); ++i)
+  {
+    apTraceContexts[staAps[i]].staIndices[Mac48Address::ConvertFrom(staDevices.Get(i)->GetAddress())] = i;
+  }
+  for (uint32_t k = 0; k < apTraceContexts.size(); ++k)
+  {
+    Ptr<WifiPhy> phy = apDevice.Get(k)->GetObject<WifiNetDevice>()->GetPhy();
+    phy->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&ApRxDropCallback, &apTraceContexts[k]));
+    phy->TraceConnectWithoutContext("MonitorSnifferRx", MakeBoundCallback(&ApMonitorSniffRxCallback, &apTraceContexts[k]));
+  }
+  sampler.SetPhyStats(downlink ? downlinkStats.phyStats : uplinkStats.phyStats);
+
+  //------------------------------------------------------------
+  //-- Setup aggregate stats and data collection
+  //------------------------------------------------------------
+  NS_LOG_INFO("Setup aggregate stats and data collection.");
+
+  // The MAC counters track how many frames are handed to the MAC of the sending side and
+  // how many are passed up by the MAC of the receiving side. Updates are triggered by the
+  // trace signals generated by the WiFi MAC model objects, connected directly to them.
+  for (uint32_t i = 0; i < staDevices.GetN(); ++i)
+  {
+    Ptr<WifiMac> staWifiMac = staDevices.Get(i)->GetObject<WifiNetDevice>()->GetMac();
+    if (downlink)
+    {
+      staWifiMac->TraceConnect("MacRx", "", MakeCallback(&PacketCounterCalculator::PacketUpdate, downlinkStats.totalMacRx));
+    }
+    if (uplink)
+    {
+      staWifiMac->TraceConnect("MacTx", "", MakeCallback(&PacketCounterCalculator::PacketUpdate, uplinkStats.totalMacTx));
+    }
+  }
+  for (uint32_t k = 0; k < apNum; ++k)
+  {
+    Ptr<WifiMac> apWifiMac = apDevice.Get(k)->GetObject<WifiNetDevice>()->GetMac();
+    if (downlink)
+    {
+      apWifiMac->TraceConnect("MacTx", "", MakeCallback(&PacketCounterCalculator::PacketUpdate, downlinkStats.totalMacTx));
+    }
+    if (uplink)
+    {
+      apWifiMac->TraceConnect("MacRx", "", MakeCallback(&PacketCounterCalculator::PacketUpdate, uplinkStats.totalMacRx));
+    }
+  }
+
+  // Ends the run early once the app throughput and delay of all the flows have converged,
+  // simTime stays the hard cap
+  ConvergenceMonitor convergence;
+  if (m_config.convergence > 0)
+  {
+    convergence.Setup(m_config.convergence, Seconds(m_config.convergenceBatch));
+    for (DirectionStats *stats : {&downlinkStats, &uplinkStats})
+    {
+      for (uint32_t i = 0; i < stats->receivers.size(); ++i)
+      {
+        convergence.AddFlow(stats->appRxCounters[i], stats->receivers[i]);
+      }
+    }
+  }
+
+  //------------------------------------------------------------
+  //-- Run the simulation
+  //------------------------------------------------------------
+  NS_LOG_INFO("Run Simulation.");
+  if (m_config.sampleInterval > 0)
+  {
+    sampler.Start();
+  }
+  // One per STA, sized up front so the pointers bound into the callbacks stay valid
+  std::vector<AssocTraceContext> assocTraceContexts(fastAssociation ? staDevices.GetN() : 0);
+  for (uint32_t i = 0; i < assocTraceContexts.size(); ++i)
+  {
+    assocTraceContexts[i].starter = &trafficStarter;
+    assocTraceContexts[i].sta = i;
+    Ptr<WifiMac> staWifiMac = staDevices.Get(i)->GetObject<WifiNetDevice>()->GetMac();
+    staWifiMac->TraceConnectWithoutContext("Assoc", MakeBoundCallback(&AssocCallback, &assocTraceContexts[i]));
+  }
+  if (fastAssociation)
+  {
+    trafficStarter.associated.assign(staDevices.GetN(), false);
+    trafficStarter.pending = staDevices.GetN();
+    trafficStarter.duration = duration;
+    if (m_config.convergence > 0)
+    {
+      trafficStarter.convergence = &convergence;
+    }
+    trafficStarter.fallback = Simulator::Schedule(Seconds(start_delay), &TrafficStarter::Start, &trafficStarter);
+  }
+  else if (m_config.convergence > 0)
+  {
+    convergence.Start(Seconds(start_delay));
+  }
+  Simulator::Stop(Seconds(simTime));
+  endSetupPhase("traces");
+  profile.setupTime = ElapsedSeconds(setupStart);
+  if (m_config.setupOnly)
+  {
+    Simulator::Destroy();
+    return results;
+  }
+  auto runStart = std::chrono::steady_clock::now();
+  Simulator::Run();
+  profile.runTime = ElapsedSeconds(runStart);
+  auto outputStart = std::chrono::steady_clock::now();
+  profile.events = Simulator::GetEventCount();
+  profile.simTime = Simulator::Now().GetSeconds();
+  profile.peakRss = GetPeakRss();
+  convergence.Stop();
+
+  // The rates are over the time the traffic actually ran
+  Time trafficStart = fastAssociation ? trafficStarter.startTime : Seconds(start_delay);
+  if (convergence.HasConverged())
+  {
+    duration = (convergence.GetStopTime() - trafficStart).GetSeconds();
+    std::cout << "Converged after " << duration << " s of traffic (throughput "
+              << convergence.GetThroughputHalfWidth() << ", delay " << convergence.GetDelayHalfWidth() << ")" << std::endl;
+  }
+  data.AddMetadata("duration", std::to_string(duration));
+  data.AddMetadata("trafficStart", std::to_string(trafficStart.GetSeconds()));
+  if (m_config.convergence > 0)
+  {
+    data.AddMetadata("converged", convergence.HasConverged() ? "true" : "false");
+  }
+  // The cost of the run, the output can't time its own writes so it's only in the results
+  data.AddMetadata("wallSetup", std::to_string(profile.setupTime));
+  data.AddMetadata("wallRun", std::to_string(profile.runTime));
+  data.AddMetadata("events", std::to_string(profile.events));
+  data.AddMetadata("eventRate", std::to_string(profile.GetEventRate()));
+  data.AddMetadata("simWallRatio", std::to_string(profile.GetSimWallRatio()));
+  data.AddMetadata("peakRss", std::to_string(profile.peakRss));
+  data.AddMetadata("peakRssScope", profile.peakRssPerRun ? "run" : "process");
+
+  // The analytical prediction of the run, to check the model against the simulation
+  WifiAnalyticEstimate &estimate = results.estimate;
+  estimate = WifiAnalyticModel::Estimate(m_config);
+  if (estimate.valid)
+  {
+    data.AddMetadata("modelLoad", std::to_string(estimate.load));
+    data.AddMetadata("modelCapacity", std::to_string(estimate.capacity));
+    if (estimate.downlink.active)
+    {
+      data.AddMetadata("modelThroughput", std::to_string(estimate.downlink.appDataRXRate));
+      data.AddMetadata("modelLossRatio", std::to_string(estimate.downlink.appDataLossRatio));
+      data.AddMetadata("modelRss", std::to_string(estimate.downlink.avgRSS));
+    }
+    if (estimate.uplink.active)
+    {
+      data.AddMetadata("modelUplinkThroughput", std::to_string(estimate.uplink.appDataRXRate));
+      data.AddMetadata("modelUplinkLossRatio", std::to_string(estimate.uplink.appDataLossRatio));
+      data.AddMetadata("modelUplinkRss", std::to_string(estimate.uplink.avgRSS));
+    }
+  }
+
+  if (m_config.sampleInterval > 0)
+  {
+    sampler.Stop();
+    std::string fileName = m_config.timeSeriesPrefix + "-" + runID + ".bin";
+    if (!sampler.Write(fileName))
+    {
+      std::cout << "Can't write the time series to " << fileName << std::endl;
+    }
+  }
+
+  //------------------------------------------------------------
+  //-- Generate statistics output.
+  //------------------------------------------------------------
+
+  downlinkStats.MergeTotals();
+  uplinkStats.MergeTotals();
+
+  Ptr<LocalDataOutput> output_local = CreateObject<LocalDataOutput>();
+
+  // Take the data from DataCollector and output it to SQLite database, columnar file and local object
+  if (m_config.dbPrefix != "" && m_config.output != "columnar")
+  {
+    Ptr<DataOutputInterface> output = CreateObject<BatchedSqliteDataOutput>();
+    output->SetFilePrefix(m_config.dbPrefix);
+    output->Output(data);
+  }
+  if (m_config.dbPrefix != "" && m_config.output != "sqlite")
+  {
+    Ptr<DataOutputInterface> output = CreateObject<ColumnarDataOutput>();
+    output->SetFilePrefix(m_config.dbPrefix);
+    output->Output(data);
+  }
+  output_local->Output(data);
+
+  results.metadata = output_local->TakeMetadata();
+  results.counters = output_local->TakeCounters();
+  const MetricStore &counters = results.counters;
+
+  if (downlink)
+  {
+    results.downlink = GetDirectionResults(downlinkStats, counters, packetSize, duration);
+  }
+  if (uplink)
+  {
+    results.uplink = GetDirectionResults(uplinkStats, counters, packetSize, duration);
+  }
+
+  profile.outputTime = ElapsedSeconds(outputStart);
+
+  // Free any memory here at the end of this run.
+  Simulator::Destroy();
+  return results;
+}
+
+void WifiScenario::PrintResults(const WifiScenarioResults &results)
+{
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(60) << "Metadata" << std::setw(20) << "Value" << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+  for (auto &data : results.metadata)
+  {
+    std::cout << std::setw(60) << data.first << std::setw(20) << data.second << std::endl;
+  }
+
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(60) << "Counter" << std::setw(20) << "Value" << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+  for (uint32_t id : results.counters.GetSortedIds())
+  {
+    // all the values are double, but some has no decimal places
+    // if the value has decimal place, then print it with 8 decimal places
+    // otherwise, print it with no decimal places
+    double value = results.counters.Get(id);
+    std::stringstream stream;
+    if (value - (int)value > 0)
+    {
+      stream << std::fixed << std::setprecision(8) << value;
+    }
+    else
+    {
+      stream << std::fixed << std::setprecision(0) << value;
+    }
+    std::cout << std::setw(60) << MetricKeys::GetName(id) << std::setw(20) << stream.str() << std::endl;
+  }
+
+  PrintMetrics(results);
+}
+
+// The metrics table of one direction, the per-STA throughput only for saturated runs.
+// The prediction of the analytical model is printed next to the metrics it covers, if there is one.
+static void PrintDirectionMetrics(const std::string &title, const WifiDirectionResults &r, bool saturated,
+                                  const WifiDirectionEstimate *estimate)
+{
+  // Print table header
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(60) << title << std::setw(20) << "Value" << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+
+  // Print data
+  std::cout << std::setw(60) << "[App] Offered Load or App Data TX Rate (kbps):" << std::setw(20) << r.appDataTXRate << std::endl;
+  std::cout << std::setw(60) << "[App] Throughput or App Data RX Rate (kbps):" << std::setw(20) << r.appDataRXRate << std::endl;
+  if (saturated)
+  {
+    for (uint32_t i = 0; i < r.staAppRxRates.size(); ++i)
+    {
+      std::cout << std::setw(60) << "[App] Saturation Throughput of STA " + std::to_string(i + 1) + " (kbps):" << std::setw(20) << r.staAppRxRates[i] << std::endl;
+    }
+  }
+  std::cout << std::setw(60) << "[App] Loss Ratio:" << std::setw(20) << r.appDataLossRatio << std::endl;
+  std::cout << std::setw(60) << "[App] Average Delay (ms):" << std::setw(20) << r.appAvgDelay << std::endl;
+  std::cout << std::setw(60) << "[App] Delay p50 / p90 (ms):" << std::setw(20) << std::to_string(r.appDelayP50) + " / " + std::to_string(r.appDelayP90) << std::endl;
+  std::cout << std::setw(60) << "[App] Delay p99 / p99.9 (ms):" << std::setw(20) << std::to_string(r.appDelayP99) + " / " + std::to_string(r.appDelayP999) << std::endl;
+  std::cout << std::setw(60) << "[App] Average Jitter (ms):" << std::setw(20) << r.appJitter << std::endl;
+  std::cout << std::setw(60) << "[App] Reordered / Duplicate Packets:" << std::setw(20) << std::to_string(r.appReordered) + " / " + std::to_string(r.appDuplicates) << std::endl;
+  std::cout << std::setw(60) << "[App] Loss Bursts / Longest Burst (packets):" << std::setw(20) << std::to_string(r.appLossBursts) + " / " + std::to_string(r.appMaxLossBurst) << std::endl;
+  std::cout << std::setw(60) << "[MAC] MAC Data TX Rate (kbps):" << std::setw(20) << r.macDataTXRate << std::endl;
+  std::cout << std::setw(60) << "[MAC] MAC Data RX Rate (kbps):" << std::setw(20) << r.macDataRXRate << std::endl;
+  std::cout << std::setw(60) << "[MAC] MAC Data Loss Ratio:" << std::setw(20) << r.macDataLossRatio << std::endl;
+  std::cout << std::setw(60) << "[Phy] WiFi Data TX Rate (kbps):" << std::setw(20) << r.wifiDataTXRate << std::endl;
+  std::cout << std::setw(60) << "[Phy] WiFi Data RX Rate (kbps):" << std::setw(20) << r.wifiDataRXRate << std::endl;
+  std::cout << std::setw(60) << "[Phy] WiFi Data Loss Ratio:" << std::setw(20) << r.wifiDataLossRatio << std::endl;
+  std::cout << std::setw(60) << "[Phy] Average RSS (dBm):" << std::setw(20) << r.avgRSS << std::endl;
+  if (estimate)
+  {
+    std::cout << std::setw(60) << "[Model] Predicted Throughput (kbps):" << std::setw(20) << estimate->appDataRXRate << std::endl;
+    std::cout << std::setw(60) << "[Model] Predicted Loss Ratio:" << std::setw(20) << estimate->appDataLossRatio << std::endl;
+    std::cout << std::setw(60) << "[Model] Predicted Average RSS (dBm):" << std::setw(20) << estimate->avgRSS << std::endl;
+  }
+}
+
+void WifiScenario::PrintMetrics(const WifiScenarioResults &results)
+{
+  auto it = results.metadata.find("trafficModel");
+  bool saturated = it != results.metadata.end() && it->second == "saturated";
+  // A downlink only run keeps the table it always had
+  const WifiAnalyticEstimate &estimate = results.estimate;
+  if (results.downlink.active)
+  {
+    PrintDirectionMetrics(results.uplink.active ? "Downlink Metric" : "Metric", results.downlink, saturated,
+                          estimate.valid ? &estimate.downlink : 0);
+  }
+  if (results.uplink.active)
+  {
+    PrintDirectionMetrics("Uplink Metric", results.uplink, saturated, estimate.valid ? &estimate.uplink : 0);
+  }
+  if (estimate.valid)
+  {
+    std::cout << std::setw(60) << "[Model] Predicted Channel Load / Capacity (kbps):" << std::setw(20)
+              << std::to_string(estimate.load) + " / " + std::to_string(estimate.capacity) << std::endl;
+  }
+
+  const WifiRunProfile &p = results.profile;
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(60) << "Profile" << std::setw(20) << "Value" << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+  std::cout << std::setw(60) << "Setup / Run / Output Wall Time (s):" << std::setw(20)
+            << std::to_string(p.setupTime) + " / " + std::to_string(p.runTime) + " / " + std::to_string(p.outputTime) << std::endl;
+  std::cout << std::setw(60) << "Events Executed:" << std::setw(20) << p.events << std::endl;
+  std::cout << std::setw(60) << "Events per Wall Second:" << std::setw(20) << p.GetEventRate() << std::endl;
+  std::cout << std::setw(60) << "Simulated / Wall Time:" << std::setw(20) << p.GetSimWallRatio() << std::endl;
+  std::cout << std::setw(60) << (p.peakRssPerRun ? "Peak RSS of the Run (MB):" : "Peak RSS of the Process (MB):")
+            << std::setw(20) << p.peakRss / 1024.0 << std::endl;
+}
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_SCENARIO_H
+#define EE500_WIFI_SCENARIO_H
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ee500_wifi_analytic.h"
+#include "ee500_wifi_metrics.h"
+#include "ee500_wifi_sketch.h"
+
+// Everything needed to describe a single simulation run.
+// Defaults are the same as the command line defaults of the simulation script.
+struct WifiScenarioConfig
+{
+  double distance = 10.0;                           // distance apart to place nodes (in meters)
+  double duration = 30;                             // Simulation Running Time (in seconds), the cap with convergence
+  uint64_t desiredDataRate = 800;                   // desired application data rate in kbps
+  uint64_t packetSize = 1000;                       // packet size in bytes
+  uint64_t packetNum = 1000000000;                  // number of packets to send
+  bool verbose = false;                             // enable/disable verbose log messages to stdout
+  bool pcap = false;                                // enable/disable pcap traces
+  uint32_t staNum = 1;                              // number of WiFi Users
+  bool debug = false;                               // enable/disable debug log messages to stdout
+  std::string standard = "ac";                      // WiFi standard [b|g|a|n|ac|ax|ax24|n24]
+  double lossExp = 3.0;                             // path loss exponent
+  double TxPowerStart = -100;                       // start of Tx power range in dBm, if -100, use default
+  double TxPowerEnd = -100;                         // end of Tx power range in dBm, if -100, use default
+  double TxPowerLevels = 1.0;                       // number of Tx power levels
+  std::string experiment = "EE500_WiFi_Performance"; // the name of the experiment
+  double channelWidth = 20;                         // channel width in MHz, default is 20 MHz
+  std::string strategy = "wifi-linear";             // By default, place STAs in a line along the x-axis
+  std::string runID = "run-" + std::to_string(time(NULL));
+  std::string input = "";                 // input for the experiment
+  std::string distancesStr = "";          // comma separated list of distances
+  std::string rateControl = "minstrelht"; // rate control algorithm
+  std::string phyRate = "VhtMcs0";        // physical rate or "DataMode" for constant rate control
+  uint32_t rngRun = 1;                    // run number for the random number generator
+  std::string dbPrefix = "data";          // file prefix of the SQLite database and the columnar results, empty to disable them
+  std::string output = "sqlite";          // result files [sqlite|columnar|both], <dbPrefix>.db and <dbPrefix>.cols
+  double sampleInterval = 0;              // interval of the time series samples in seconds, 0 to disable them
+  uint32_t sampleCapacity = 0;            // number of time series samples kept, 0 to keep all of them
+  std::string timeSeriesPrefix = "timeseries"; // file prefix of the time series, the runID is appended
+  std::string trafficModel = "cbr";       // packet arrivals [cbr|poisson|onoff-exp|onoff-pareto|saturated]
+  double onTime = 1.0;                    // mean on period of the on/off models in seconds
+  double offTime = 1.0;                   // mean off period of the on/off models in seconds
+  double paretoShape = 1.5;               // shape of the Pareto on/off periods, must be above 1
+  std::string packetSizeDist = "constant"; // packet sizes [constant|uniform|exponential], the mean is packetSize
+  uint64_t packetSizeMin = 64;            // smallest packet of the uniform packet sizes in bytes
+  uint32_t saturationWindow = 0;          // packets of every flow kept in the AP's MAC queue when saturated, 0 to size it from the queue
+  double startJitter = 1.0;               // random start offset of every flow in mean packet intervals, 0 starts all flows together
+  std::string direction = "downlink";     // flows of every STA [downlink|uplink|both], downlink is AP to STA
+  double convergence = 0;                 // relative CI half-width of app throughput and delay that ends the run early, 0 to disable
+  double convergenceBatch = 0.5;          // length of the batches of the convergence check in seconds
+  bool fastAssociation = false;           // short beacon interval and active probing, traffic starts once every STA is associated
+  uint32_t apNum = 1;                     // number of APs, more than one needs a layout
+  std::string layout = "";                // generated placement [grid|random|clustered|floorplan], empty places the STAs around one AP by strategy
+  double areaWidth = 100;                 // width of the area of the layout in meters
+  double areaHeight = 100;                // height of the area of the layout in meters
+  uint32_t clusterNum = 0;                // STA clusters of the clustered layout, 0 means one per AP
+  double clusterRadius = 5;               // standard deviation of the STA offsets from their cluster center in meters
+  double roomSize = 10;                   // side of the rooms of the floorplan layout in meters
+  uint32_t topologySeed = 0;              // seed of the layout, 0 uses rngRun
+  bool lossMatrix = false;                // log-distance losses of all node pairs computed once after placement
+  bool rangeLimit = false;                // deliver frames only to the PHYs that can receive them, see rangeMargin
+  double rangeMargin = 0;                 // dB below the RxSensitivity of the receivers still delivered, 0 or more keeps the results
+  bool setupOnly = false;                 // build everything and stop before Simulator::Run(), only the profile is filled in
+};
+
+// Sets a configuration parameter by its command line name, e.g. ("staNum", "10").
+// Returns false if the name is unknown or the value can't be parsed: numbers have to be the whole value,
+// unsigned ones without a sign, booleans are true, false, 1 or 0, and the enumerated parameters
+// (standard, rateControl, trafficModel, ...) only take their own values.
+bool SetScenarioParameter(WifiScenarioConfig &config, const std::string &name, const std::string &value);
+
+// Checks what Run() can't simulate before anything is built: the enumerated parameters, the channel width,
+// the on/off periods, the packet sizes, the convergence batches and the layout.
+// Returns false and what's wrong in error if the configuration is invalid.
+bool ValidateScenarioConfig(const WifiScenarioConfig &config, std::string &error);
+
+struct WifiTopologyConfig;
+
+// The parameters of the layout of a configuration, the topology generator places the nodes the same way every time
+WifiTopologyConfig GetTopologyConfig(const WifiScenarioConfig &config);
+
+// Metrics of the flows in one direction, downlink (AP to STAs) or uplink (STAs to AP).
+struct WifiDirectionResults
+{
+  bool active = false;           // the run had flows in this direction
+
+  double appDataTXRate = 0.0;    // kbps
+  double appDataRXRate = 0.0;    // kbps
+  double appDataLossRatio = 0.0;
+  double appAvgDelay = 0.0;      // ms
+  double appDelayP50 = 0.0;      // ms
+  double appDelayP90 = 0.0;      // ms
+  double appDelayP99 = 0.0;      // ms
+  double appDelayP999 = 0.0;     // ms
+  double appJitter = 0.0;        // ms, RFC 3550 jitter averaged over the STAs
+  uint64_t appReordered = 0;
+  uint64_t appDuplicates = 0;
+  uint64_t appLossBursts = 0;
+  uint64_t appMaxLossBurst = 0;  // packets
+  double macDataTXRate = 0.0;    // kbps
+  double macDataRXRate = 0.0;    // kbps
+  double macDataLossRatio = 0.0;
+  double wifiDataTXRate = 0.0;   // kbps
+  double wifiDataRXRate = 0.0;   // kbps
+  double wifiDataLossRatio = 0.0;
+  double avgRSS = 0.0;           // dBm, at the STAs for the downlink, at the AP for the uplink
+  std::vector<double> staAppRxRates; // kbps, the App Data RX Rate of the flow of every STA
+
+  // Delays of all the STAs (ns), can be merged with the ones of other runs
+  DelaySketch delaySketch;
+};
+
+// Wall-clock cost of a single run, to budget sweeps and spot runs that blow up.
+// Setup is everything before Simulator::Run(), output everything after it.
+struct WifiRunProfile
+{
+  double setupTime = 0.0;  // s
+  double runTime = 0.0;    // s
+  double outputTime = 0.0; // s, statistics and result files
+  uint64_t events = 0;     // events executed by the simulator
+  double simTime = 0.0;    // s, simulated
+  uint64_t peakRss = 0;    // kB, peak resident set size of the run, see peakRssPerRun
+  bool peakRssPerRun = false; // false if the peak couldn't be reset and is the one of the process so far
+  std::vector<std::pair<std::string, double>> setupPhases; // s, every part of the setup in order
+
+  // Events per wall second and simulated seconds per wall second of Simulator::Run()
+  double GetEventRate() const;
+  double GetSimWallRatio() const;
+};
+
+// What a single simulation run produces.
+struct WifiScenarioResults
+{
+  // Set if the configuration was invalid or the setup failed, nothing else is filled in then
+  bool failed = false;
+  std::string error;
+
+  MetricStore counters;  // named <variable>_<context>, see MetricKeys
+  std::map<std::string, std::string> metadata;
+
+  WifiDirectionResults downlink;
+  WifiDirectionResults uplink;
+
+  WifiRunProfile profile;
+
+  // What the analytical model predicted for the run, see WifiAnalyticModel
+  WifiAnalyticEstimate estimate;
+};
+
+// A single EE500 WiFi simulation: one AP and staNum STAs, traffic from the AP to every STA,
+// from every STA to the AP or both. With a layout there are apNum APs, each with the STAs nearest to it,
+// and the flows of every STA go to and from its own AP.
+// Run() builds the topology, runs the simulator, collects the statistics and
+// destroys the simulator, so several scenarios can be run one after another in one process.
+// An invalid configuration doesn't stop the process, Run() returns failed results instead.
+class WifiScenario
+{
+public:
+  WifiScenario(const WifiScenarioConfig &config);
+
+  const WifiScenarioConfig &GetConfig() const;
+
+  WifiScenarioResults Run();
+
+  // Print the metadata, counters and metrics tables of a finished run
+  static void PrintResults(const WifiScenarioResults &results);
+  static void PrintMetrics(const WifiScenarioResults &results);
+
+private:
+  WifiScenarioConfig m_config;
+};
+
+#endif /* EE500_WIFI_SCENARIO_H */
@@ -0,0 +1,543 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+#include "ee500_wifi_scenario_file.h"
+
+//------------------------------------------------------------
+//-- JSON parser
+//------------------------------------------------------------
+
+// Only what a scenario file needs: the values keep the text they were written with,
+// so numbers reach SetScenarioParameter() the same way they do from the command line.
+struct JsonValue
+{
+  enum Type
+  {
+    NUL,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT
+  };
+
+  Type type = NUL;
+  std::string text;                                          // scalars: "true"/"false", the number or the string
+  std::vector<JsonValue> items;                              // arrays
+  std::vector<std::pair<std::string, JsonValue>> members;    // objects, in the order of the file
+  uint32_t line = 0;                                         // where the value starts
+};
+
+class JsonParser
+{
+public:
+  JsonParser(const std::string &text) : m_text(text),
+                                        m_pos(0),
+                                        m_line(1)
+  {
+  }
+
+  // Parses the whole text as one value
+  bool Parse(JsonValue &value)
+  {
+    if (!ParseValue(value))
+    {
+      return false;
+    }
+    SkipSpace();
+    if (m_pos < m_text.size())
+    {
+      return Fail("unexpected text after the end");
+    }
+    return true;
+  }
+
+  const std::string &GetError() const
+  {
+    return m_error;
+  }
+
+private:
+  bool Fail(const std::string &message)
+  {
+    if (m_error == "")
+    {
+      m_error = "line " + std::to_string(m_line) + ": " + message;
+    }
+    return false;
+  }
+
+  void SkipSpace()
+  {
+    while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+    {
+      if (m_text[m_pos] == '\n')
+      {
+        m_line++;
+      }
+      m_pos++;
+    }
+  }
+
+  bool Expect(char c)
+  {
+    SkipSpace();
+    if (m_pos >= m_text.size() || m_text[m_pos] != c)
+    {
+      return Fail(std::string("expected '") + c + "'");
+    }
+    m_pos++;
+    return true;
+  }
+
+  bool ParseValue(JsonValue &value)
+  {
+    SkipSpace();
+    value.line = m_line;
+    if (m_pos >= m_text.size())
+    {
+      return Fail("unexpected end of the file");
+    }
+    char c = m_text[m_pos];
+    if (c == '{')
+    {
+      return ParseObject(value);
+    }
+    if (c == '[')
+    {
+      return ParseArray(value);
+    }
+    if (c == '"')
+    {
+      value.type = JsonValue::STRING;
+      return ParseString(value.text);
+    }
+    if (c == '-' || std::isdigit(static_cast<unsigned char>(c)))
+    {
+      return ParseNumber(value);
+    }
+    return ParseLiteral(value);
+  }
+
+  bool ParseObject(JsonValue &value)
+  {
+    value.type = JsonValue::OBJECT;
+    m_pos++; // '{'
+    SkipSpace();
+    if (m_pos < m_text.size() && m_text[m_pos] == '}')
+    {
+      m_pos++;
+      return true;
+    }
+    while (true)
+    {
+      SkipSpace();
+      if (m_pos >= m_text.size() || m_text[m_pos] != '"')
+      {
+        return Fail("expected a quoted name");
+      }
+      std::pair<std::string, JsonValue> member;
+      if (!ParseString(member.first) || !Expect(':') || !ParseValue(member.second))
+      {
+        return false;
+      }
+      value.members.push_back(std::move(member));
+      SkipSpace();
+      if (m_pos < m_text.size() && m_text[m_pos] == ',')
+      {
+        m_pos++;
+        continue;
+      }
+      return Expect('}');
+    }
+  }
+
+  bool ParseArray(JsonValue &value)
+  {
+    value.type = JsonValue::ARRAY;
+    m_pos++; // '['
+    SkipSpace();
+    if (m_pos < m_text.size() && m_text[m_pos] == ']')
+    {
+      m_pos++;
+      return true;
+    }
+    while (true)
+    {
+      JsonValue item;
+      if (!ParseValue(item))
+      {
+        return false;
+      }
+      value.items.push_back(std::move(item));
+      SkipSpace();
+      if (m_pos < m_text.size() && m_text[m_pos] == ',')
+      {
+        m_pos++;
+        continue;
+      }
+      return Expect(']');
+    }
+  }
+
+  bool ParseString(std::string &text)
+  {
+    m_pos++; // '"'
+    while (m_pos < m_text.size())
+    {
+      char c = m_text[m_pos++];
+      if (c == '"')
+      {
+        return true;
+      }
+      if (c == '\n')
+      {
+        return Fail("unterminated string");
+      }
+      if (c != '\\')
+      {
+        text += c;
+        continue;
+      }
+      if (m_pos >= m_text.size())
+      {
+        break;
+      }
+      c = m_text[m_pos++];
+      switch (c)
+      {
+      case '"':
+      case '\\':
+      case '/':
+        text += c;
+        break;
+      case 'b':
+        text += '\b';
+        break;
+      case 'f':
+        text += '\f';
+        break;
+      case 'n':
+        text += '\n';
+        break;
+      case 'r':
+        text += '\r';
+        break;
+      case 't':
+        text += '\t';
+        break;
+      case 'u':
+      {
+        // Encoded as UTF-8, surrogate pairs aren't needed for parameter values
+        if (m_pos + 4 > m_text.size())
+        {
+          return Fail("bad \\u escape");
+        }
+        uint32_t code;
+        std::stringstream hex(m_text.substr(m_pos, 4));
+        if (!(hex >> std::hex >> code))
+        {
+          return Fail("bad \\u escape");
+        }
+        m_pos += 4;
+        if (code < 0x80)
+        {
+          text += static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+          text += static_cast<char>(0xc0 | code >> 6);
+          text += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else
+        {
+          text += static_cast<char>(0xe0 | code >> 12);
+          text += static_cast<char>(0x80 | (code >> 6 & 0x3f));
+          text += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        break;
+      }
+      default:
+        return Fail(std::string("bad escape \\") + c);
+      }
+    }
+    return Fail("unterminated string");
+  }
+
+  bool ParseNumber(JsonValue &value)
+  {
+    value.type = JsonValue::NUMBER;
+    size_t start = m_pos;
+    while (m_pos < m_text.size() && (std::isdigit(static_cast<unsigned char>(m_text[m_pos])) ||
+                                     m_text[m_pos] == '-' || m_text[m_pos] == '+' ||
+                                     m_text[m_pos] == '.' || m_text[m_pos] == 'e' || m_text[m_pos] == 'E'))
+    {
+      m_pos++;
+    }
+    value.text = m_text.substr(start, m_pos - start);
+    // The token must be a whole number, "1.2.3" or "1-2" are not
+    std::istringstream check(value.text);
+    double number;
+    if (!(check >> number) || check.peek() != std::char_traits<char>::eof())
+    {
+      return Fail("bad number " + value.text);
+    }
+    return true;
+  }
+
+  bool ParseLiteral(JsonValue &value)
+  {
+    static const char *literals[] = {"true", "false", "null"};
+    for (const char *literal : literals)
+    {
+      std::string word(literal);
+      if (m_text.compare(m_pos, word.size(), word) == 0)
+      {
+        m_pos += word.size();
+        value.type = word == "null" ? JsonValue::NUL : JsonValue::BOOLEAN;
+        value.text = word == "null" ? "" : word;
+        return true;
+      }
+    }
+    return Fail("unexpected character '" + std::string(1, m_text[m_pos]) + "'");
+  }
+
+  const std::string &m_text;
+  size_t m_pos;
+  uint32_t m_line;
+  std::string m_error;
+};
+
+//------------------------------------------------------------
+//-- Scenario file
+//------------------------------------------------------------
+
+static bool IsScalar(const JsonValue &value)
+{
+  return value.type == JsonValue::BOOLEAN || value.type == JsonValue::NUMBER || value.type == JsonValue::STRING;
+}
+
+static bool FileError(const std::string &path, const JsonValue &value, const std::string &message)
+{
+  std::cout << path << ":" << value.line << ": " << message << std::endl;
+  return false;
+}
+
+// A whole number of at least 0 for the options that aren't scenario parameters
+static bool GetCount(const std::string &path, const std::string &name, const JsonValue &value, uint32_t &count)
+{
+  try
+  {
+    if (value.type == JsonValue::NUMBER && value.text[0] != '-')
+    {
+      size_t end;
+      unsigned long number = std::stoul(value.text, &end);
+      if (end == value.text.size())
+      {
+        count = number;
+        return true;
+      }
+    }
+  }
+  catch (const std::exception &e)
+  {
+  }
+  return FileError(path, value, name + " must be a whole number");
+}
+
+// A number of at least 0 for the options that aren't scenario parameters
+static bool GetMargin(const std::string &path, const std::string &name, const JsonValue &value, double &margin)
+{
+  try
+  {
+    if (value.type == JsonValue::NUMBER && value.text[0] != '-')
+    {
+      size_t end;
+      double number = std::stod(value.text, &end);
+      if (end == value.text.size())
+      {
+        margin = number;
+        return true;
+      }
+    }
+  }
+  catch (const std::exception &e)
+  {
+  }
+  return FileError(path, value, name + " must be a number of at least 0");
+}
+
+// The STAs in order, e.g. [ { "distance": 40 }, { "distance": 50 } ], become the comma separated "distances"
+static bool LoadStations(const std::string &path, const JsonValue &stations, WifiScenarioFile &file)
+{
+  if (stations.type != JsonValue::ARRAY)
+  {
+    return FileError(path, stations, "stations must be a list of objects");
+  }
+  std::string distances;
+  for (auto &station : stations.items)
+  {
+    if (station.type != JsonValue::OBJECT)
+    {
+      return FileError(path, station, "a station must be an object");
+    }
+    bool hasDistance = false;
+    for (auto &attribute : station.members)
+    {
+      if (attribute.first != "distance" || attribute.second.type != JsonValue::NUMBER)
+      {
+        return FileError(path, attribute.second, "unknown station attribute or bad value: " + attribute.first);
+      }
+      distances += (distances == "" ? "" : ",") + attribute.second.text;
+      hasDistance = true;
+    }
+    // The distances are positional, a gap would shift the STAs after it
+    if (!hasDistance)
+    {
+      return FileError(path, station, "a station needs its distance");
+    }
+  }
+  return SetScenarioParameter(file.config, "distances", distances) ||
+         FileError(path, stations, "bad station distances");
+}
+
+// Every dimension is a list of values, or a single value
+static bool LoadSweep(const std::string &path, const JsonValue &sweep, WifiScenarioFile &file)
+{
+  if (sweep.type != JsonValue::OBJECT)
+  {
+    return FileError(path, sweep, "sweep must be an object of parameter lists");
+  }
+  for (auto &member : sweep.members)
+  {
+    const std::string &name = member.first;
+    std::vector<JsonValue> items;
+    if (member.second.type == JsonValue::ARRAY)
+    {
+      items = member.second.items;
+    }
+    else
+    {
+      items.push_back(member.second);
+    }
+
+    SweepDimension dimension;
+    dimension.name = name;
+    for (auto &item : items)
+    {
+      // Check the value once here, so a typo is reported before anything runs.
+      // What only fails together with other parameters fails that point, and the sweep skips it.
+      WifiScenarioConfig check = file.config;
+      if (!IsScalar(item) || !SetScenarioParameter(check, name, item.text))
+      {
+        return FileError(path, item, "unknown sweep parameter or bad value: " + name + "=" + item.text);
+      }
+      dimension.values.push_back(item.text);
+    }
+    if (dimension.values.empty())
+    {
+      return FileError(path, member.second, "sweep dimension without values: " + name);
+    }
+    file.sweep.push_back(dimension);
+  }
+  return true;
+}
+
+// The members of the top level object and of the objects that group them
+static bool LoadMembers(const std::string &path, const JsonValue &object, WifiScenarioFile &file)
+{
+  for (auto &member : object.members)
+  {
+    const std::string &name = member.first;
+    const JsonValue &value = member.second;
+    bool ok;
+    if (name == "sweep")
+    {
+      ok = LoadSweep(path, value, file);
+    }
+    else if (name == "stations")
+    {
+      ok = LoadStations(path, value, file);
+    }
+    else if (name == "trials")
+    {
+      ok = GetCount(path, name, value, file.trials);
+    }
+    else if (name == "workers")
+    {
+      ok = GetCount(path, name, value, file.workers);
+    }
+    else if (name == "prescreen")
+    {
+      ok = GetMargin(path, name, value, file.prescreen);
+    }
+    else if (value.type == JsonValue::OBJECT)
+    {
+      ok = LoadMembers(path, value, file);
+    }
+    else if (IsScalar(value))
+    {
+      ok = SetScenarioParameter(file.config, name, value.text) ||
+           FileError(path, value, "unknown parameter or bad value: " + name + "=" + value.text);
+    }
+    else
+    {
+      ok = FileError(path, value, "only sweep dimensions take lists of values: " + name);
+    }
+    if (!ok)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LoadScenarioFile(const std::string &path, WifiScenarioFile &file)
+{
+  std::ifstream in(path.c_str());
+  if (!in)
+  {
+    std::cout << "Can't open scenario file " << path << std::endl;
+    return false;
+  }
+  std::stringstream text;
+  text << in.rdbuf();
+
+  // The parser keeps a reference to the text
+  std::string content = text.str();
+  JsonValue root;
+  JsonParser parser(content);
+  if (!parser.Parse(root))
+  {
+    std::cout << "Can't parse scenario file " << path << ", " << parser.GetError() << std::endl;
+    return false;
+  }
+  if (root.type != JsonValue::OBJECT)
+  {
+    return FileError(path, root, "the scenario must be an object");
+  }
+  return LoadMembers(path, root, file);
+}
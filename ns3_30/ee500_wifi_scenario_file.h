@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_SCENARIO_FILE_H
+#define EE500_WIFI_SCENARIO_FILE_H
+
+#include <string>
+#include <vector>
+
+#include "ee500_wifi_scenario.h"
+#include "ee500_wifi_sweep.h"
+
+// A scenario file: the configuration of the runs and the sweep grid over it, parsed once.
+// The file is a JSON object. Its members are the command line parameters of the simulation,
+// and objects in it only group them, so the topology, traffic and PHY settings can be kept apart:
+//   {
+//     "experiment": "EE500_WiFi_Performance",
+//     "topology": { "staNum": 3, "strategy": "wifi-radial", "distance": 10,
+//                   "stations": [ { "distance": 40 }, { "distance": 50 } ] },
+//     "traffic":  { "trafficModel": "poisson", "desiredDataRate": 1000 },
+//     "phy":      { "standard": "ac", "rateControl": "minstrelht" },
+//     "sweep":    { "staNum": [ 1, 5, 10 ], "lossExp": [ 2.5, 3 ], "direction": [ "downlink", "both" ] },
+//     "trials": 3,
+//     "workers": 0,
+//     "prescreen": 0.5
+//   }
+// "stations" sets the attributes of the STAs in order, the ones it doesn't list keep the defaults.
+// "sweep" has the dimensions of the grid, in the order of the loops, outermost first,
+// "trials", "workers" and "prescreen" are the same as the command line options of the sweep.
+struct WifiScenarioFile
+{
+  WifiScenarioConfig config;
+  std::vector<SweepDimension> sweep;
+  uint32_t trials = 1;
+  uint32_t workers = 1;
+  double prescreen = 0;
+};
+
+// Reads the scenario file on top of what the file already holds (usually the defaults).
+// Prints what's wrong and returns false if the file can't be read or has unknown parameters or bad values.
+bool LoadScenarioFile(const std::string &path, WifiScenarioFile &file);
+
+#endif /* EE500_WIFI_SCENARIO_FILE_H */
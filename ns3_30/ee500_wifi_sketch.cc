@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "ee500_wifi_sketch.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("DelaySketch");
+
+//------------------------------------------------------------
+//-- DelaySketch
+//------------------------------------------------------------
+
+DelaySketch::DelaySketch() : m_count(0),
+                             m_min(std::numeric_limits<uint64_t>::max()),
+                             m_max(0)
+{
+}
+
+uint32_t DelaySketch::GetBucket(uint64_t value)
+{
+  value >>= UNIT_BITS;
+  if (value < SUB_BUCKETS)
+  {
+    return value;
+  }
+  // Position of the highest set bit, at least SUB_BUCKET_BITS here
+  uint32_t exponent = 63 - __builtin_clzll(value);
+  if (exponent > MAX_EXPONENT)
+  {
+    return MAX_BUCKETS - 1;
+  }
+  uint32_t shift = exponent - SUB_BUCKET_BITS;
+  // value >> shift is in [SUB_BUCKETS, 2 * SUB_BUCKETS)
+  return (shift + 1) * SUB_BUCKETS + static_cast<uint32_t>(value >> shift) - SUB_BUCKETS;
+}
+
+uint64_t DelaySketch::GetBucketLow(uint32_t bucket)
+{
+  if (bucket < SUB_BUCKETS)
+  {
+    return static_cast<uint64_t>(bucket) << UNIT_BITS;
+  }
+  uint32_t shift = bucket / SUB_BUCKETS - 1;
+  return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << (shift + UNIT_BITS);
+}
+
+uint64_t DelaySketch::GetBucketWidth(uint32_t bucket)
+{
+  if (bucket < SUB_BUCKETS)
+  {
+    return static_cast<uint64_t>(1) << UNIT_BITS;
+  }
+  return static_cast<uint64_t>(1) << (bucket / SUB_BUCKETS - 1 + UNIT_BITS);
+}
+
+void DelaySketch::Update(uint64_t value)
+{
+  if (m_buckets.empty())
+  {
+    m_buckets.assign(MAX_BUCKETS, 0);
+  }
+  m_buckets[GetBucket(value)]++;
+  m_count++;
+  if (value < m_min)
+  {
+    m_min = value;
+  }
+  if (value > m_max)
+  {
+    m_max = value;
+  }
+}
+
+void DelaySketch::Merge(const DelaySketch &other)
+{
+  if (other.m_buckets.empty())
+  {
+    return;
+  }
+  if (m_buckets.empty())
+  {
+    m_buckets = other.m_buckets;
+  }
+  else
+  {
+    for (uint32_t i = 0; i < MAX_BUCKETS; ++i)
+    {
+      m_buckets[i] += other.m_buckets[i];
+    }
+  }
+  m_count += other.m_count;
+  if (other.m_min < m_min)
+  {
+    m_min = other.m_min;
+  }
+  if (other.m_max > m_max)
+  {
+    m_max = other.m_max;
+  }
+}
+
+void DelaySketch::Reset()
+{
+  m_buckets.clear();
+  m_count = 0;
+  m_min = std::numeric_limits<uint64_t>::max();
+  m_max = 0;
+}
+
+uint64_t DelaySketch::GetCount() const
+{
+  return m_count;
+}
+
+uint64_t DelaySketch::GetMin() const
+{
+  return m_count > 0 ? m_min : 0;
+}
+
+uint64_t DelaySketch::GetMax() const
+{
+  return m_max;
+}
+
+uint64_t DelaySketch::GetQuantile(double quantile) const
+{
+  if (m_count == 0)
+  {
+    return 0;
+  }
+
+  // Rank of the value, 1 is the smallest one
+  uint64_t rank = static_cast<uint64_t>(std::ceil(quantile * m_count));
+  if (rank < 1)
+  {
+    rank = 1;
+  }
+
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < MAX_BUCKETS; ++i)
+  {
+    seen += m_buckets[i];
+    if (seen >= rank)
+    {
+      // Middle of the bucket, clamped to what was actually seen
+      uint64_t value = GetBucketLow(i) + GetBucketWidth(i) / 2;
+      if (value < m_min)
+      {
+        value = m_min;
+      }
+      if (value > m_max)
+      {
+        value = m_max;
+      }
+      return value;
+    }
+  }
+  return m_max;
+}
+
+void DelaySketch::Write(std::ostream &out) const
+{
+  uint32_t buckets = m_buckets.size();
+  out.write(reinterpret_cast<const char *>(&m_count), sizeof(m_count));
+  out.write(reinterpret_cast<const char *>(&m_min), sizeof(m_min));
+  out.write(reinterpret_cast<const char *>(&m_max), sizeof(m_max));
+  out.write(reinterpret_cast<const char *>(&buckets), sizeof(buckets));
+  if (buckets > 0)
+  {
+    out.write(reinterpret_cast<const char *>(m_buckets.data()), buckets * sizeof(uint32_t));
+  }
+}
+
+bool DelaySketch::Read(std::istream &in)
+{
+  uint32_t buckets = 0;
+  in.read(reinterpret_cast<char *>(&m_count), sizeof(m_count));
+  in.read(reinterpret_cast<char *>(&m_min), sizeof(m_min));
+  in.read(reinterpret_cast<char *>(&m_max), sizeof(m_max));
+  in.read(reinterpret_cast<char *>(&buckets), sizeof(buckets));
+  if (!in || (buckets != 0 && buckets != MAX_BUCKETS))
+  {
+    Reset();
+    return false;
+  }
+  m_buckets.assign(buckets, 0);
+  if (buckets > 0)
+  {
+    in.read(reinterpret_cast<char *>(m_buckets.data()), buckets * sizeof(uint32_t));
+  }
+  if (!in)
+  {
+    Reset();
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------
+//-- DelayQuantileCalculator
+//------------------------------------------------------------
+
+TypeId
+DelayQuantileCalculator::GetTypeId(void)
+{
+  static TypeId tid = TypeId("DelayQuantileCalculator")
+                          .SetParent<DataCalculator>()
+                          .AddConstructor<DelayQuantileCalculator>();
+  return tid;
+}
+
+DelayQuantileCalculator::DelayQuantileCalculator()
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+DelayQuantileCalculator::~DelayQuantileCalculator()
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+void DelayQuantileCalculator::DoDispose(void)
+{
+  NS_LOG_FUNCTION_NOARGS();
+  // chain up
+  DataCalculator::DoDispose();
+}
+
+void DelayQuantileCalculator::Merge(const DelayQuantileCalculator &other)
+{
+  m_sketch.Merge(other.m_sketch);
+}
+
+const DelaySketch &
+DelayQuantileCalculator::GetSketch() const
+{
+  return m_sketch;
+}
+
+void DelayQuantileCalculator::Output(DataOutputCallback &callback) const
+{
+  callback.OutputSingleton(m_context, m_key + "-p50", NanoSeconds(m_sketch.GetQuantile(0.5)));
+  callback.OutputSingleton(m_context, m_key + "-p90", NanoSeconds(m_sketch.GetQuantile(0.9)));
+  callback.OutputSingleton(m_context, m_key + "-p99", NanoSeconds(m_sketch.GetQuantile(0.99)));
+  callback.OutputSingleton(m_context, m_key + "-p99.9", NanoSeconds(m_sketch.GetQuantile(0.999)));
+}
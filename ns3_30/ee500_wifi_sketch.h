@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_SKETCH_H
+#define EE500_WIFI_SKETCH_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/stats-module.h"
+
+using namespace ns3;
+
+// Log-linear histogram of non-negative integer values (delays in ns), in the style of HDR histograms.
+// Values are counted in units of 2^UNIT_BITS ns (about 1 us). Below 32 units every unit has its own
+// bucket, above that every power of two is split into 32 buckets, so a value is reported with at most
+// 1/32 (3.1%) relative error. Values from 2^(MAX_EXPONENT + 1) units (about 275 s) on share the last bucket.
+// The buckets are only allocated by the first value, a sketch that never sees one (there is one per STA
+// and direction) stays a few words. Update() is O(1) and two histograms are merged by adding their
+// counters, so per-STA histograms can be combined across STAs and across runs.
+class DelaySketch
+{
+public:
+  static const uint32_t UNIT_BITS = 10;
+  static const uint32_t SUB_BUCKET_BITS = 5;
+  static const uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static const uint32_t MAX_EXPONENT = 27;
+  static const uint32_t MAX_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+  DelaySketch();
+
+  void Update(uint64_t value);
+  void Merge(const DelaySketch &other);
+  void Reset();
+
+  uint64_t GetCount() const;
+  uint64_t GetMin() const;
+  uint64_t GetMax() const;
+
+  // Value at the given quantile (0 to 1), 0 if the histogram is empty
+  uint64_t GetQuantile(double quantile) const;
+
+  // Binary form of the histogram, to pass it between processes. Read() returns false on a short read.
+  void Write(std::ostream &out) const;
+  bool Read(std::istream &in);
+
+  // Bucket of a value and the values of a bucket, in ns
+  static uint32_t GetBucket(uint64_t value);
+  static uint64_t GetBucketLow(uint32_t bucket);
+  static uint64_t GetBucketWidth(uint32_t bucket);
+
+private:
+  std::vector<uint32_t> m_buckets; // empty until the first value
+
+  uint64_t m_count;
+  uint64_t m_min;
+  uint64_t m_max;
+};
+
+// Delay percentiles of one receiver (or of several, merged) for the DataCollector.
+// Output() writes <key>-p50, -p90, -p99 and -p99.9 as Time singletons in the same units
+// as the <key>-average of TimeMinMaxAvgTotalCalculator (nanoseconds in the SQLite database).
+class DelayQuantileCalculator : public DataCalculator
+{
+public:
+  static TypeId GetTypeId(void);
+  DelayQuantileCalculator();
+  virtual ~DelayQuantileCalculator();
+
+  inline void Update(const Time delay)
+  {
+    if (m_enabled)
+    {
+      m_sketch.Update(delay.IsPositive() ? delay.GetNanoSeconds() : 0);
+    }
+  }
+
+  void Merge(const DelayQuantileCalculator &other);
+
+  const DelaySketch &GetSketch() const;
+
+  virtual void Output(DataOutputCallback &callback) const;
+
+protected:
+  virtual void DoDispose(void);
+
+private:
+  DelaySketch m_sketch;
+};
+
+#endif /* EE500_WIFI_SKETCH_H */
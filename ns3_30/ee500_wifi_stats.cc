@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include "ee500_wifi_stats.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("WifiStats");
+
+//------------------------------------------------------------
+//-- WifiPhyStats
+//------------------------------------------------------------
+
+// Indexed by WifiPhyRxfailureReason
+static const char *const g_rxFailureReasonNames[RX_FAILURE_REASONS] = {
+    "unknown",
+    "unsupported-settings",
+    "not-allowed",
+    "erroneous-frame",
+    "mpdu-without-phy-header",
+    "preamble-detect-failure",
+    "l-sig-failure",
+    "sig-a-failure",
+    "preamble-detection-packet-switch",
+    "frame-capture-packet-switch",
+    "obss-pd-cca-reset",
+};
+
+const char *GetRxFailureReasonName(uint32_t reason)
+{
+  return reason < RX_FAILURE_REASONS ? g_rxFailureReasonNames[reason] : g_rxFailureReasonNames[UNKNOWN];
+}
+
+TypeId
+WifiPhyStats::GetTypeId(void)
+{
+  static TypeId tid = TypeId("WifiPhyStats")
+                          .SetParent<DataCalculator>()
+                          .AddConstructor<WifiPhyStats>();
+  return tid;
+}
+
+WifiPhyStats::WifiPhyStats()
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+WifiPhyStats::~WifiPhyStats()
+{
+  NS_LOG_FUNCTION_NOARGS();
+}
+
+void WifiPhyStats::DoDispose(void)
+{
+  NS_LOG_FUNCTION_NOARGS();
+
+  m_counters.clear();
+  // chain up
+  DataCalculator::DoDispose();
+}
+
+void WifiPhyStats::SetStaNum(uint32_t staNum)
+{
+  m_counters.assign(staNum, StaPhyCounters());
+}
+
+uint32_t WifiPhyStats::GetStaNum() const
+{
+  return m_counters.size();
+}
+
+const StaPhyCounters &
+WifiPhyStats::GetCounters(uint32_t sta) const
+{
+  return m_counters[sta];
+}
+
+StaPhyCounters WifiPhyStats::GetTotal() const
+{
+  StaPhyCounters total;
+  for (auto &counters : m_counters)
+  {
+    total.rxCount += counters.rxCount;
+    total.rxBytes += counters.rxBytes;
+    total.dropCount += counters.dropCount;
+    total.dropBytes += counters.dropBytes;
+    total.rssSum += counters.rssSum;
+    for (uint32_t reason = 0; reason < RX_FAILURE_REASONS; ++reason)
+    {
+      total.dropReasons[reason] += counters.dropReasons[reason];
+    }
+  }
+  return total;
+}
+
+void WifiPhyStats::OutputCounters(DataOutputCallback &callback, const std::string &context, const StaPhyCounters &counters) const
+{
+  callback.OutputSingleton(context, m_key + "-drop-count", static_cast<uint32_t>(counters.dropCount));
+  callback.OutputSingleton(context, m_key + "-drop-bytes", static_cast<double>(counters.dropBytes));
+  callback.OutputSingleton(context, m_key + "-rx-count", static_cast<uint32_t>(counters.rxCount));
+  callback.OutputSingleton(context, m_key + "-rx-bytes", static_cast<double>(counters.rxBytes));
+  callback.OutputSingleton(context, m_key + "-tx-count", static_cast<uint32_t>(counters.rxCount + counters.dropCount));
+  callback.OutputSingleton(context, m_key + "-tx-bytes", static_cast<double>(counters.rxBytes + counters.dropBytes));
+  callback.OutputSingleton(context, m_key + "-rx-rss-sum", counters.rssSum);
+  // The names are only put together here, never per dropped frame
+  for (uint32_t reason = 0; reason < RX_FAILURE_REASONS; ++reason)
+  {
+    callback.OutputSingleton(context, m_key + "-drop-" + GetRxFailureReasonName(reason),
+                             static_cast<uint32_t>(counters.dropReasons[reason]));
+  }
+}
+
+void WifiPhyStats::Output(DataOutputCallback &callback) const
+{
+  // Node 0 is the AP, the STAs are nodes 1 to staNum
+  for (uint32_t i = 0; i < m_counters.size(); ++i)
+  {
+    OutputCounters(callback, "node[" + std::to_string(i + 1) + "]", m_counters[i]);
+  }
+  OutputCounters(callback, "aggregate", GetTotal());
+}
+
+//------------------------------------------------------------
+//-- PHY trace callbacks
+//------------------------------------------------------------
+
+// For packets received by STAs from the AP
+// Mac1 = destination, Mac2 = BSSID, Mac3 = original source
+// BSSID = AP MAC
+static inline bool MatchMpdu(const StaTraceContext *context, const WifiMacHeader &macHeader, uint32_t &sta)
+{
+  sta = context->staIndex;
+  return macHeader.IsData() && macHeader.GetAddr3() == context->apMac && context->staMac == macHeader.GetAddr1();
+}
+
+// For packets received by the AP from the STAs
+// Mac1 = BSSID, Mac2 = source, Mac3 = final destination
+// BSSID = AP MAC, the source tells the STA
+static inline bool MatchMpdu(const ApTraceContext *context, const WifiMacHeader &macHeader, uint32_t &sta)
+{
+  if (!macHeader.IsData() || !macHeader.IsToDs() || macHeader.GetAddr1() != context->apMac)
+  {
+    return false;
+  }
+  auto it = context->staIndices.find(macHeader.GetAddr2());
+  if (it == context->staIndices.end())
+  {
+    return false;
+  }
+  sta = it->second;
+  return true;
+}
+
+static inline void CountRxMpdu(WifiPhyStats *phyStats, uint32_t sta, uint32_t size, double signal)
+{
+  StaPhyCounters &counters = phyStats->GetCounters(sta);
+  counters.rxCount++;
+  counters.rxBytes += size;
+  // Calculate the Recieved Signal Strength Indicator (RSSI) in dBm
+  counters.rssSum += signal;
+}
+
+template <typename Context>
+static inline void CountDrop(const Context *context, Ptr<const Packet> packet, WifiPhyRxfailureReason reason)
+{
+  // packet here is a single MPDU, the header is only peeked at, the packet is never copied
+  WifiMacHeader macHeader;
+  packet->PeekHeader(macHeader);
+
+  uint32_t sta;
+  if (MatchMpdu(context, macHeader, sta))
+  {
+    NS_LOG_LOGIC("RxDrop at " << Simulator::Now().GetSeconds() << ", Reason: " << GetRxFailureReasonName(reason));
+    StaPhyCounters &counters = context->phyStats->GetCounters(sta);
+    counters.dropCount++;
+    counters.dropBytes += packet->GetSize();
+    // Reasons out of range are counted as UNKNOWN
+    counters.dropReasons[reason < RX_FAILURE_REASONS ? reason : UNKNOWN]++;
+  }
+}
+
+template <typename Context>
+static inline void CountSniffRx(const Context *context, Ptr<const Packet> packet, double signal)
+{
+  // packet here can be a single MPDU or an A-MPDU
+  // Headers are only peeked at, neither the packet nor the MPDUs are copied
+  WifiMacHeader macHeader;
+  uint32_t sta;
+  if (IsAmpdu(packet))
+  {
+    // we received A-MPDU
+    std::list<Ptr<const Packet>> mpdus = MpduAggregator::PeekMpdus(packet);
+    NS_LOG_LOGIC("A-MPDU received, number of MPDUs: " << mpdus.size());
+    for (auto &mpdu : mpdus)
+    {
+      mpdu->PeekHeader(macHeader);
+      if (MatchMpdu(context, macHeader, sta))
+      {
+        NS_LOG_LOGIC("\tMPDU size: " << mpdu->GetSize());
+        CountRxMpdu(context->phyStats, sta, mpdu->GetSize(), signal);
+      }
+    }
+  }
+  else
+  {
+    NS_LOG_LOGIC("MPDU received");
+    uint32_t headerSize = packet->PeekHeader(macHeader);
+    if (MatchMpdu(context, macHeader, sta))
+    {
+      // The size of a single MPDU is counted without the MAC header
+      uint32_t size = packet->GetSize() - headerSize;
+      NS_LOG_LOGIC("\tMPDU size: " << size);
+      CountRxMpdu(context->phyStats, sta, size, signal);
+    }
+  }
+}
+
+void RxDropCallback(const StaTraceContext *context,
+                    Ptr<const Packet> packet, WifiPhyRxfailureReason reason)
+{
+  CountDrop(context, packet, reason);
+}
+
+void MonitorSniffRxCallback(const StaTraceContext *context,
+                            Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                            WifiTxVector txVector, MpduInfo aMpdu,
+                            SignalNoiseDbm signalNoise)
+{
+  CountSniffRx(context, packet, signalNoise.signal);
+}
+
+void ApRxDropCallback(const ApTraceContext *context,
+                      Ptr<const Packet> packet, WifiPhyRxfailureReason reason)
+{
+  CountDrop(context, packet, reason);
+}
+
+void ApMonitorSniffRxCallback(const ApTraceContext *context,
+                              Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                              WifiTxVector txVector, MpduInfo aMpdu,
+                              SignalNoiseDbm signalNoise)
+{
+  CountSniffRx(context, packet, signalNoise.signal);
+}
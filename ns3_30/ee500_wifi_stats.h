@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_STATS_H
+#define EE500_WIFI_STATS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/stats-module.h"
+
+using namespace ns3;
+
+// Number of WifiPhyRxfailureReason values, OBSS_PD_CCA_RESET is the last one
+const uint32_t RX_FAILURE_REASONS = OBSS_PD_CCA_RESET + 1;
+
+// Name of a drop reason as used in the output, e.g. "preamble-detect-failure".
+// Reasons out of range are reported as "unknown".
+const char *GetRxFailureReasonName(uint32_t reason);
+
+// PHY counters of one STA in one direction. Only unicast data MPDUs between the AP and the STA are counted,
+// at the STA for the downlink and at the AP for the uplink.
+// Every MPDU sent is either received or dropped, so the sent counts are the sums of both.
+struct StaPhyCounters
+{
+  uint64_t rxCount = 0;   // received MPDUs
+  uint64_t rxBytes = 0;   // bytes of the received MPDUs
+  uint64_t dropCount = 0; // dropped MPDUs
+  uint64_t dropBytes = 0; // bytes of the dropped MPDUs
+  double rssSum = 0.0;    // sum of RSSI values for all received Data MPDUs (dBm)
+  uint64_t dropReasons[RX_FAILURE_REASONS] = {}; // dropped MPDUs by WifiPhyRxfailureReason
+};
+
+// PHY statistics of all the STAs in one calculator.
+// The counters are kept in one contiguous array indexed by the station ordinal (0 for the first STA),
+// so an update is a plain increment and 100+ STAs don't add hundreds of calculators to the DataCollector.
+// Output() writes the counters of every STA with the node[i] context, the same way the
+// per-STA app calculators do, followed by the sums over all STAs with the "aggregate" context.
+// The names start with the key, e.g. phy-mpdu-rx-count for the key "phy-mpdu".
+// The drops are also written per reason, as <key>-drop-<reason>.
+class WifiPhyStats : public DataCalculator
+{
+public:
+  static TypeId GetTypeId(void);
+  WifiPhyStats();
+  virtual ~WifiPhyStats();
+
+  // Sets the number of STAs and resets all the counters
+  void SetStaNum(uint32_t staNum);
+  uint32_t GetStaNum() const;
+
+  inline StaPhyCounters &GetCounters(uint32_t sta)
+  {
+    return m_counters[sta];
+  }
+  const StaPhyCounters &GetCounters(uint32_t sta) const;
+
+  // Sum of the counters of all STAs
+  StaPhyCounters GetTotal() const;
+
+  virtual void Output(DataOutputCallback &callback) const;
+
+protected:
+  virtual void DoDispose(void);
+
+private:
+  void OutputCounters(DataOutputCallback &callback, const std::string &context, const StaPhyCounters &counters) const;
+
+  std::vector<StaPhyCounters> m_counters;
+};
+
+// Everything the PHY trace callbacks of one STA need.
+// It's resolved once when the traces are connected and bound into the callbacks,
+// so nothing has to be looked up per frame.
+struct StaTraceContext
+{
+  Mac48Address staMac;     // MAC address of the STA the PHY belongs to
+  Mac48Address apMac;      // MAC address of the AP
+  uint32_t staIndex;       // ordinal of the STA in phyStats
+  WifiPhyStats *phyStats;  // where to count
+};
+
+// Everything the PHY trace callbacks of the AP need to count the uplink MPDUs of every STA,
+// resolved once and bound into the callbacks the same way
+struct ApTraceContext
+{
+  Mac48Address apMac;                           // MAC address of the AP
+  std::map<Mac48Address, uint32_t> staIndices;  // ordinal in phyStats of every STA by its MAC address
+  WifiPhyStats *phyStats;                       // where to count
+};
+
+// PhyRxDrop trace sink of a STA. The packet is a single MPDU.
+void RxDropCallback(const StaTraceContext *context,
+                    Ptr<const Packet> packet, WifiPhyRxfailureReason reason);
+
+// MonitorSnifferRx trace sink of a STA. The packet is a single MPDU or an A-MPDU.
+void MonitorSniffRxCallback(const StaTraceContext *context,
+                            Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                            WifiTxVector txVector, MpduInfo aMpdu,
+                            SignalNoiseDbm signalNoise);
+
+// The same trace sinks for the PHY of the AP, they count the MPDUs the STAs send to the AP
+void ApRxDropCallback(const ApTraceContext *context,
+                      Ptr<const Packet> packet, WifiPhyRxfailureReason reason);
+void ApMonitorSniffRxCallback(const ApTraceContext *context,
+                              Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                              WifiTxVector txVector, MpduInfo aMpdu,
+                              SignalNoiseDbm signalNoise);
+
+#endif /* EE500_WIFI_STATS_H */
@@ -0,0 +1,452 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ns3/core-module.h"
+
+#include "ee500_wifi_suite.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("WifiBenchmarkSuite");
+
+// The setup output of the runs, the suite prints only its own tables
+static const char *BENCH_LOG = "bench-suite.txt";
+
+// The cost metrics and whether a higher value is better, all the other metrics are results
+static const std::map<std::string, bool> COST_METRICS = {
+    {"wallSetup", false},
+    {"wallRun", false},
+    {"wallOutput", false},
+    {"eventRate", true},
+    {"peakRss", false},
+};
+
+// Differences of the wall times below this are timer noise, whatever the tolerance (s)
+static const double MIN_WALL_CHANGE = 0.01;
+
+//------------------------------------------------------------
+//-- Cases
+//------------------------------------------------------------
+
+// The same traffic for every case: STAs around the AP at 10 meters, 200 kbps each for 5 seconds
+static BenchmarkCase MakeCase(uint32_t staNum, const std::string &standard, const std::string &rateControl,
+                              const std::string &phyRate)
+{
+  BenchmarkCase benchmarkCase;
+  benchmarkCase.name = standard + "-" + rateControl + "-" + std::to_string(staNum);
+  WifiScenarioConfig &config = benchmarkCase.config;
+  config.staNum = staNum;
+  config.standard = standard;
+  config.rateControl = rateControl;
+  if (phyRate != "")
+  {
+    config.phyRate = phyRate;
+  }
+  config.strategy = "wifi-radial";
+  config.distance = 10;
+  config.duration = 5;
+  config.desiredDataRate = 200;
+  config.rngRun = 1;
+  config.experiment = "EE500_WiFi_Benchmark";
+  config.runID = "bench-" + benchmarkCase.name;
+  config.dbPrefix = "";
+  return benchmarkCase;
+}
+
+std::vector<BenchmarkCase> WifiBenchmarkSuite::GetCases(const std::string &suite)
+{
+  // Every standard with the rate control meant for it, and a constant rate it has
+  struct StandardRates
+  {
+    const char *standard;
+    const char *rateControl;
+    const char *phyRate;
+  };
+  static const StandardRates standards[] = {
+      {"b", "minstrel", "DsssRate11Mbps"},
+      {"g", "minstrel", "ErpOfdmRate24Mbps"},
+      {"a", "minstrel", "OfdmRate24Mbps"},
+      {"n", "minstrelht", "HtMcs4"},
+      {"ac", "minstrelht", "VhtMcs4"},
+      {"ax", "minstrelht", "HeMcs4"},
+  };
+
+  std::vector<BenchmarkCase> cases;
+  if (suite != "quick" && suite != "full")
+  {
+    return cases;
+  }
+  cases.push_back(MakeCase(1, "ac", "minstrelht", ""));
+  for (auto &s : standards)
+  {
+    cases.push_back(MakeCase(10, s.standard, s.rateControl, ""));
+  }
+  if (suite == "full")
+  {
+    for (auto &s : standards)
+    {
+      cases.push_back(MakeCase(10, s.standard, "constant", s.phyRate));
+    }
+    for (uint32_t staNum : {50, 100, 200})
+    {
+      cases.push_back(MakeCase(staNum, "ac", "minstrelht", ""));
+    }
+  }
+  return cases;
+}
+
+//------------------------------------------------------------
+//-- WifiBenchmarkSuite
+//------------------------------------------------------------
+
+WifiBenchmarkSuite::WifiBenchmarkSuite() : m_costTolerance(0.25),
+                                           m_resultTolerance(1e-6),
+                                           m_repeats(1)
+{
+}
+
+bool WifiBenchmarkSuite::SetSuite(const std::string &suite)
+{
+  m_cases = GetCases(suite);
+  if (m_cases.empty())
+  {
+    std::cout << "Unknown benchmark suite: " << suite << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void WifiBenchmarkSuite::SetTolerances(double cost, double result)
+{
+  m_costTolerance = cost;
+  m_resultTolerance = result;
+}
+
+void WifiBenchmarkSuite::SetRepeats(uint32_t repeats)
+{
+  m_repeats = repeats > 0 ? repeats : 1;
+}
+
+static BenchmarkValues GetValues(const WifiScenarioResults &results)
+{
+  const WifiRunProfile &profile = results.profile;
+  const WifiDirectionResults &downlink = results.downlink;
+  BenchmarkValues values;
+  values["wallSetup"] = profile.setupTime;
+  values["wallRun"] = profile.runTime;
+  values["wallOutput"] = profile.outputTime;
+  values["eventRate"] = profile.GetEventRate();
+  values["peakRss"] = profile.peakRss;
+  values["events"] = profile.events;
+  values["simTime"] = profile.simTime;
+  values["throughput"] = downlink.appDataRXRate;
+  values["lossRatio"] = downlink.appDataLossRatio;
+  values["avgDelay"] = downlink.appAvgDelay;
+  values["delayP99"] = downlink.appDelayP99;
+  values["macRxRate"] = downlink.macDataRXRate;
+  values["avgRss"] = downlink.avgRSS;
+  return values;
+}
+
+bool WifiBenchmarkSuite::RunCase(const BenchmarkCase &benchmarkCase, BenchmarkValues &values) const
+{
+  int fds[2];
+  if (pipe(fds) != 0)
+  {
+    std::cout << "Can't create the pipe of case " << benchmarkCase.name << std::endl;
+    return false;
+  }
+  std::cout.flush();
+  pid_t pid = fork();
+  if (pid < 0)
+  {
+    std::cout << "Can't start case " << benchmarkCase.name << std::endl;
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0)
+  {
+    close(fds[0]);
+    if (freopen(BENCH_LOG, "a", stdout) == NULL)
+    {
+      std::cerr << "Case " << benchmarkCase.name << ": can't open " << BENCH_LOG << std::endl;
+    }
+    WifiScenario scenario(benchmarkCase.config);
+    WifiScenarioResults results = scenario.Run();
+    std::cout.flush();
+    if (results.failed)
+    {
+      close(fds[1]);
+      _exit(1);
+    }
+
+    // Full precision, the results are compared exactly
+    std::ostringstream out;
+    out << std::setprecision(17);
+    for (auto &it : GetValues(results))
+    {
+      out << it.first << " " << it.second << "\n";
+    }
+    std::string text = out.str();
+    bool written = write(fds[1], text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fds[1]);
+    _exit(written ? 0 : 1);
+  }
+
+  // Read everything before waiting, a full pipe would block the child
+  close(fds[1]);
+  std::string text;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+  {
+    text.append(buffer, n);
+  }
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    std::cout << "Case " << benchmarkCase.name << " failed, see " << BENCH_LOG << std::endl;
+    return false;
+  }
+
+  std::istringstream in(text);
+  std::string metric;
+  std::string value;
+  while (in >> metric >> value)
+  {
+    values[metric] = std::strtod(value.c_str(), NULL);
+  }
+  return true;
+}
+
+// Equal values, NaN included: a metric with nothing to average is NaN in every run
+static bool SameValue(double a, double b)
+{
+  return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+bool WifiBenchmarkSuite::Run()
+{
+  std::remove(BENCH_LOG);
+  m_values.clear();
+  bool ok = true;
+  for (uint32_t i = 0; i < m_cases.size(); ++i)
+  {
+    const BenchmarkCase &benchmarkCase = m_cases[i];
+    std::cout << "Case " << i + 1 << "/" << m_cases.size() << ": " << benchmarkCase.name << std::endl;
+
+    BenchmarkValues best;
+    bool failed = false;
+    for (uint32_t r = 0; r < m_repeats && !failed; ++r)
+    {
+      BenchmarkValues values;
+      if (!RunCase(benchmarkCase, values))
+      {
+        failed = true;
+        break;
+      }
+      if (r == 0)
+      {
+        best = values;
+        continue;
+      }
+      // The fastest run counts, the results of a fixed seed must not change
+      for (auto &it : values)
+      {
+        auto cost = COST_METRICS.find(it.first);
+        double &kept = best[it.first];
+        if (cost != COST_METRICS.end())
+        {
+          kept = cost->second ? std::max(kept, it.second) : std::min(kept, it.second);
+        }
+        else if (!SameValue(kept, it.second))
+        {
+          std::cout << "Case " << benchmarkCase.name << ": " << it.first << " differs between runs, "
+                    << kept << " vs " << it.second << std::endl;
+          failed = true;
+        }
+      }
+    }
+    if (failed)
+    {
+      ok = false;
+      continue;
+    }
+    m_values[benchmarkCase.name] = best;
+  }
+
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(24) << "Case" << std::setw(14) << "Setup (s)" << std::setw(14) << "Run (s)"
+            << std::setw(14) << "Events/s" << std::setw(14) << "Peak RSS (MB)" << std::endl;
+  std::cout << std::setfill('-') << std::setw(80) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+  for (auto &benchmarkCase : m_cases)
+  {
+    auto it = m_values.find(benchmarkCase.name);
+    if (it == m_values.end())
+    {
+      continue;
+    }
+    BenchmarkValues values = it->second;
+    std::cout << std::setw(24) << benchmarkCase.name << std::setw(14) << values["wallSetup"]
+              << std::setw(14) << values["wallRun"] << std::setw(14) << values["eventRate"]
+              << std::setw(14) << values["peakRss"] / 1024 << std::endl;
+  }
+  return ok;
+}
+
+bool WifiBenchmarkSuite::Save(const std::string &path) const
+{
+  std::ofstream out(path);
+  if (!out)
+  {
+    std::cout << "Can't write the benchmark baseline " << path << std::endl;
+    return false;
+  }
+  out << "# EE500 WiFi benchmark baseline: case metric value" << std::endl;
+  out << std::setprecision(17);
+  for (auto &benchmarkCase : m_cases)
+  {
+    auto it = m_values.find(benchmarkCase.name);
+    if (it == m_values.end())
+    {
+      continue;
+    }
+    for (auto &value : it->second)
+    {
+      out << benchmarkCase.name << " " << value.first << " " << value.second << std::endl;
+    }
+  }
+  std::cout << "Benchmark baseline saved to " << path << std::endl;
+  return static_cast<bool>(out);
+}
+
+bool WifiBenchmarkSuite::Compare(const std::string &path) const
+{
+  std::ifstream in(path);
+  if (!in)
+  {
+    std::cout << "Can't read the benchmark baseline " << path << std::endl;
+    return false;
+  }
+  std::map<std::string, BenchmarkValues> baseline;
+  std::string line;
+  while (std::getline(in, line))
+  {
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+    std::istringstream fields(line);
+    std::string name;
+    std::string metric;
+    std::string value;
+    if (fields >> name >> metric >> value)
+    {
+      baseline[name][metric] = std::strtod(value.c_str(), NULL);
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << std::left << std::setw(24) << "Case" << std::setw(12) << "Metric" << std::setw(14) << "Baseline"
+            << std::setw(14) << "Current" << std::setw(10) << "Change" << std::setw(10) << "Status" << std::endl;
+  std::cout << std::setfill('-') << std::setw(84) << "-" << std::endl; // Print line
+  std::cout << std::setfill(' ');                                      // Reset fill character
+
+  uint32_t regressions = 0;
+  for (auto &benchmarkCase : m_cases)
+  {
+    auto measured = m_values.find(benchmarkCase.name);
+    if (measured == m_values.end())
+    {
+      continue;
+    }
+    auto base = baseline.find(benchmarkCase.name);
+    for (auto &it : measured->second)
+    {
+      const std::string &metric = it.first;
+      double current = it.second;
+      std::string status = "ok";
+      double reference = std::nan("");
+      if (base == baseline.end() || base->second.count(metric) == 0)
+      {
+        status = "new";
+      }
+      else
+      {
+        reference = base->second.at(metric);
+        auto cost = COST_METRICS.find(metric);
+        if (cost != COST_METRICS.end())
+        {
+          // Only getting worse by more than the tolerance counts
+          bool worse = cost->second ? current * (1 + m_costTolerance) < reference
+                                    : current > reference * (1 + m_costTolerance);
+          if (metric.compare(0, 4, "wall") == 0 && current - reference < MIN_WALL_CHANGE)
+          {
+            worse = false;
+          }
+          if (worse)
+          {
+            status = metric == "peakRss" ? "BIGGER" : "SLOWER";
+          }
+        }
+        else if (!SameValue(current, reference) &&
+                 !(std::fabs(current - reference) <= m_resultTolerance * std::fabs(reference)))
+        {
+          status = "CHANGED";
+        }
+      }
+      if (status != "ok" && status != "new")
+      {
+        regressions++;
+      }
+
+      std::stringstream change;
+      if (reference != 0 && std::isfinite(reference) && std::isfinite(current))
+      {
+        change << std::fixed << std::setprecision(1) << std::showpos << (current - reference) / std::fabs(reference) * 100 << "%";
+      }
+      std::cout << std::setw(24) << benchmarkCase.name << std::setw(12) << metric << std::setw(14) << reference
+                << std::setw(14) << current << std::setw(10) << change.str() << std::setw(10) << status << std::endl;
+    }
+  }
+
+  std::cout << std::endl;
+  if (regressions > 0)
+  {
+    std::cout << regressions << " metrics got worse or changed against " << path << std::endl;
+    return false;
+  }
+  std::cout << "No regressions against " << path << std::endl;
+  return true;
+}
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_SUITE_H
+#define EE500_WIFI_SUITE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ee500_wifi_scenario.h"
+
+// One canonical scenario of the benchmark suite
+struct BenchmarkCase
+{
+  std::string name;
+  WifiScenarioConfig config;
+};
+
+// What a case measured, by metric name
+typedef std::map<std::string, double> BenchmarkValues;
+
+// Performance benchmark of whole simulation runs, run with --benchSuite=<quick|full>.
+// The cases cover staNum from 1 to 200, the standards from b to ax and the rate control modes,
+// all with fixed seeds and without result files. Every case runs in a process of its own,
+// so the peak RSS is the one of the case. The cost (wall times, events per second, peak RSS) and
+// the key results of every case can be saved as a baseline and compared against one later:
+// the cost may get worse by the cost tolerance, the results must stay within the result tolerance.
+class WifiBenchmarkSuite
+{
+public:
+  WifiBenchmarkSuite();
+
+  // Selects the cases of the suite [quick|full]. Returns false if there is no such suite.
+  bool SetSuite(const std::string &suite);
+
+  // Relative tolerances, e.g. 0.25 lets a case run 25% longer than the baseline
+  void SetTolerances(double cost, double result);
+
+  // Number of times every case is run, the fastest run counts. The results must not differ between them.
+  void SetRepeats(uint32_t repeats);
+
+  // Runs all the cases one after another. Returns false if a case failed.
+  bool Run();
+
+  // Saves the measured values as a baseline. Returns false if the file can't be written.
+  bool Save(const std::string &path) const;
+
+  // Compares the measured values against the baseline and prints the differences.
+  // Returns false if the baseline can't be read or a case is slower, bigger or gives other results.
+  bool Compare(const std::string &path) const;
+
+  static std::vector<BenchmarkCase> GetCases(const std::string &suite);
+
+private:
+  // Runs the case in a child process. Returns false if it failed.
+  bool RunCase(const BenchmarkCase &benchmarkCase, BenchmarkValues &values) const;
+
+  std::vector<BenchmarkCase> m_cases;
+  double m_costTolerance;
+  double m_resultTolerance;
+  uint32_t m_repeats;
+  std::map<std::string, BenchmarkValues> m_values; // by case name
+};
+
+#endif /* EE500_WIFI_SUITE_H */
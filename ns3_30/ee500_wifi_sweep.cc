@@ -0,0 +1,503 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ns3/core-module.h"
+
+#include "ee500_wifi_data.h"
+#include "ee500_wifi_sweep.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("WifiSweep");
+
+const double WifiSweep::LINK_MARGIN = 3.0;
+
+WifiSweep::WifiSweep(const WifiScenarioConfig &base) : m_base(base),
+                                                       m_trials(1),
+                                                       m_prescreen(0),
+                                                       m_failed(0)
+{
+}
+
+bool WifiSweep::Parse(const std::string &spec)
+{
+  std::stringstream ss(spec);
+  std::string item;
+  while (std::getline(ss, item, '/'))
+  {
+    if (item == "")
+    {
+      continue;
+    }
+
+    size_t pos = item.find('=');
+    if (pos == std::string::npos)
+    {
+      std::cout << "Sweep dimension without values: " << item << std::endl;
+      return false;
+    }
+
+    std::string name = item.substr(0, pos);
+    std::vector<std::string> values;
+    std::stringstream vs(item.substr(pos + 1));
+    std::string value;
+    while (std::getline(vs, value, ':'))
+    {
+      // Check the value once here, so a typo is reported before anything runs.
+      // What only fails together with other parameters fails that point, and the sweep skips it.
+      WifiScenarioConfig check = m_base;
+      if (!SetScenarioParameter(check, name, value))
+      {
+        std::cout << "Unknown sweep parameter or bad value: " << name << "=" << value << std::endl;
+        return false;
+      }
+      values.push_back(value);
+    }
+    AddDimension(name, values);
+  }
+  return true;
+}
+
+void WifiSweep::AddDimension(const std::string &name, const std::vector<std::string> &values)
+{
+  SweepDimension dimension;
+  dimension.name = name;
+  dimension.values = values;
+  m_dimensions.push_back(dimension);
+}
+
+void WifiSweep::SetTrials(uint32_t trials)
+{
+  m_trials = trials;
+}
+
+void WifiSweep::SetPrescreen(double margin)
+{
+  m_prescreen = margin;
+}
+
+std::vector<SweepPoint> WifiSweep::GetPoints() const
+{
+  std::vector<SweepPoint> points;
+
+  // Number of points in one trial, an empty dimension means an empty grid
+  size_t gridSize = 1;
+  for (auto &dimension : m_dimensions)
+  {
+    gridSize *= dimension.values.size();
+  }
+
+  for (uint32_t trial = 1; trial <= m_trials; ++trial)
+  {
+    for (size_t n = 0; n < gridSize; ++n)
+    {
+      SweepPoint point;
+      point.trial = trial;
+      point.config = m_base;
+      // The first dimension is the outermost loop, same as in wifi.sh
+      std::string runID = std::to_string(trial);
+      std::string input = "";
+      size_t stride = gridSize;
+      for (auto &dimension : m_dimensions)
+      {
+        stride /= dimension.values.size();
+        const std::string &value = dimension.values[(n / stride) % dimension.values.size()];
+        SetScenarioParameter(point.config, dimension.name, value);
+        runID += "-" + value;
+        input += (input == "" ? "" : ",") + dimension.name + "=" + value;
+      }
+      point.config.runID = runID;
+      point.config.input = input;
+      // Different trials use different random number streams
+      point.config.rngRun = m_base.rngRun + trial - 1;
+      points.push_back(point);
+    }
+  }
+  return points;
+}
+
+std::vector<SweepPoint> WifiSweep::Prescreen(const std::vector<SweepPoint> &points) const
+{
+  if (m_prescreen <= 0)
+  {
+    return points;
+  }
+
+  std::vector<SweepPoint> kept;
+  std::vector<std::pair<const SweepPoint *, WifiAnalyticEstimate>> skipped;
+  for (auto &point : points)
+  {
+    WifiAnalyticEstimate estimate = WifiAnalyticModel::Estimate(point.config);
+    bool transition = !estimate.valid || std::isinf(estimate.load) ||
+                      (estimate.load >= 1.0 / (1.0 + m_prescreen) && estimate.load <= 1.0 + m_prescreen) ||
+                      std::fabs(estimate.linkMargin) < LINK_MARGIN;
+    if (transition)
+    {
+      kept.push_back(point);
+    }
+    else
+    {
+      skipped.push_back(std::make_pair(&point, estimate));
+    }
+  }
+
+  std::cout << "Pre-screen: simulating " << kept.size() << " of " << points.size()
+            << " points, the others are predicted by the model." << std::endl;
+  if (!skipped.empty())
+  {
+    std::cout << std::setw(8) << "Trial" << std::setw(40) << "Input" << std::setw(12) << "Load"
+              << std::setw(20) << "Throughput (kbps)" << std::setw(12) << "Loss" << std::endl;
+    for (auto &it : skipped)
+    {
+      // The throughput of both directions, the loss of the downlink unless there's none
+      const WifiAnalyticEstimate &e = it.second;
+      const WifiDirectionEstimate &main = e.downlink.active ? e.downlink : e.uplink;
+      std::cout << std::setw(8) << it.first->trial << std::setw(40) << it.first->config.input
+                << std::setw(12) << e.load
+                << std::setw(20) << e.downlink.appDataRXRate + e.uplink.appDataRXRate
+                << std::setw(12) << main.appDataLossRatio << std::endl;
+    }
+  }
+  return kept;
+}
+
+uint32_t WifiSweep::Run()
+{
+  return RunPoints(Prescreen(GetPoints()));
+}
+
+// The delays of every point merged over its trials, by input, the uplink ones under "<input> uplink"
+typedef std::map<std::string, DelaySketch> PointDelays;
+
+static void AddPointDelays(PointDelays &pointDelays, const SweepPoint &point, const WifiScenarioResults &results)
+{
+  if (results.downlink.active)
+  {
+    pointDelays[point.config.input].Merge(results.downlink.delaySketch);
+  }
+  if (results.uplink.active)
+  {
+    pointDelays[point.config.input + " uplink"].Merge(results.uplink.delaySketch);
+  }
+}
+
+// The sketches of all trials of a point merge into the percentiles of the whole point
+static void PrintPointDelays(const PointDelays &pointDelays, uint32_t trials)
+{
+  std::cout << std::endl;
+  std::cout << "Delay percentiles over " << trials << " trials (ms):" << std::endl;
+  std::cout << std::setw(40) << "Input" << std::setw(12) << "p50" << std::setw(12) << "p90"
+            << std::setw(12) << "p99" << std::setw(12) << "p99.9" << std::endl;
+  for (auto &it : pointDelays)
+  {
+    std::cout << std::setw(40) << it.first
+              << std::setw(12) << it.second.GetQuantile(0.5) / 1e6
+              << std::setw(12) << it.second.GetQuantile(0.9) / 1e6
+              << std::setw(12) << it.second.GetQuantile(0.99) / 1e6
+              << std::setw(12) << it.second.GetQuantile(0.999) / 1e6 << std::endl;
+  }
+}
+
+// A worker hands its point delays to the sweep process in a file
+static bool WritePointDelays(const std::string &fileName, const PointDelays &pointDelays)
+{
+  std::ofstream out(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  for (auto &it : pointDelays)
+  {
+    uint32_t keyLength = it.first.size();
+    out.write(reinterpret_cast<const char *>(&keyLength), sizeof(keyLength));
+    out.write(it.first.data(), keyLength);
+    it.second.Write(out);
+  }
+  out.close();
+  return !out.fail();
+}
+
+// Merges the point delays of a worker into the ones of the sweep
+static bool ReadPointDelays(const std::string &fileName, PointDelays &pointDelays)
+{
+  std::ifstream in(fileName.c_str(), std::ios::binary);
+  if (!in)
+  {
+    return false;
+  }
+  uint32_t keyLength;
+  while (in.read(reinterpret_cast<char *>(&keyLength), sizeof(keyLength)))
+  {
+    std::string key(keyLength, ' ');
+    DelaySketch sketch;
+    if (!in.read(&key[0], keyLength) || !sketch.Read(in))
+    {
+      return false;
+    }
+    pointDelays[key].Merge(sketch);
+  }
+  return in.eof();
+}
+
+uint32_t WifiSweep::GetFailed() const
+{
+  return m_failed;
+}
+
+uint32_t WifiSweep::RunPoints(const std::vector<SweepPoint> &points)
+{
+  PointDelays pointDelays;
+  uint32_t count = 0;
+  m_failed = 0;
+  for (auto &point : points)
+  {
+    std::cout << std::endl;
+    std::cout << "Point " << ++count << "/" << points.size()
+              << " Trial: " << point.trial << " Input: " << point.config.input << std::endl;
+
+    // Run() destroys the simulator at the end, the next point starts from a clean state
+    WifiScenario scenario(point.config);
+    WifiScenarioResults results = scenario.Run();
+    if (results.failed)
+    {
+      std::cout << "Point " << count << " failed, skipped: " << results.error << std::endl;
+      ++m_failed;
+      continue;
+    }
+    WifiScenario::PrintMetrics(results);
+    AddPointDelays(pointDelays, point, results);
+  }
+
+  if (m_trials > 1)
+  {
+    PrintPointDelays(pointDelays, m_trials);
+  }
+  return count;
+}
+
+// Rough relative cost of a point: every STA adds its own traffic flows, every AP its beacons,
+// and the simulated time includes the association delay, fixed unless it's fast.
+static double EstimateCost(const WifiScenarioConfig &config)
+{
+  double flows = config.direction == "both" ? 2.0 : 1.0;
+  double associationDelay = config.fastAssociation ? 1.0 : 5.0;
+  return (config.staNum * flows + config.apNum) * (config.duration + associationDelay);
+}
+
+// The shards the workers wrote. Every point writes the result files of its own output, and output can be swept,
+// so a sweep can leave shards of both kinds whatever the output of the base configuration is.
+static std::vector<std::string> GetWrittenShards(const std::vector<std::string> &shards)
+{
+  std::vector<std::string> written;
+  for (auto &shard : shards)
+  {
+    if (access(shard.c_str(), F_OK) == 0)
+    {
+      written.push_back(shard);
+    }
+  }
+  return written;
+}
+
+// Shared between the worker processes of a parallel sweep
+struct SweepQueue
+{
+  std::atomic<uint32_t> next;   // index of the next point to run
+  std::atomic<uint32_t> failed; // points whose scenario failed
+};
+
+uint32_t WifiSweep::RunParallel(uint32_t workers)
+{
+  std::vector<SweepPoint> points = Prescreen(GetPoints());
+  if (workers == 0)
+  {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = cores > 0 ? cores : 1;
+  }
+  if (workers > points.size())
+  {
+    workers = points.size();
+  }
+  if (workers <= 1)
+  {
+    return RunPoints(points);
+  }
+
+  // Longest points first, so the short ones fill the gaps at the end of the sweep
+  std::stable_sort(points.begin(), points.end(), [](const SweepPoint &a, const SweepPoint &b) {
+    return EstimateCost(a.config) > EstimateCost(b.config);
+  });
+
+  void *shared = mmap(NULL, sizeof(SweepQueue), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED)
+  {
+    std::cout << "Can't allocate the shared sweep queue, running the points in this process." << std::endl;
+    return RunPoints(points);
+  }
+  SweepQueue *queue = new (shared) SweepQueue();
+  queue->next = 0;
+  queue->failed = 0;
+
+  std::cout << "Running " << points.size() << " points in " << workers << " worker processes." << std::endl;
+  std::cout.flush();
+  // The workers must not share the databases this process has open
+  CloseSqliteDatabases();
+
+  std::vector<std::string> shards;
+  std::vector<std::string> columnarShards;
+  std::vector<std::string> delayFiles;
+  std::vector<pid_t> pids;
+  for (uint32_t k = 0; k < workers; ++k)
+  {
+    std::string shardPrefix = m_base.dbPrefix + "-shard" + std::to_string(k);
+    shards.push_back(shardPrefix + ".db");
+    columnarShards.push_back(shardPrefix + ".cols");
+    // A shard left over from an interrupted sweep would be merged twice
+    std::remove(shards.back().c_str());
+    std::remove(columnarShards.back().c_str());
+    // With several trials the worker hands the delays of its points back for the percentiles over the trials
+    std::string delayFile = m_base.dbPrefix + "-worker" + std::to_string(k) + ".delays";
+    std::remove(delayFile.c_str());
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+      std::cout << "Can't start worker " << k << std::endl;
+      shards.pop_back();
+      columnarShards.pop_back();
+      break;
+    }
+    if (pid == 0)
+    {
+      // Worker: the setup output of the runs goes to a log file, the progress goes to stderr
+      std::string log = m_base.dbPrefix + "-worker" + std::to_string(k) + ".txt";
+      if (freopen(log.c_str(), "w", stdout) == NULL)
+      {
+        std::cerr << "Worker " << k << ": can't open " << log << std::endl;
+      }
+
+      PointDelays pointDelays;
+      uint32_t i;
+      while ((i = queue->next.fetch_add(1)) < points.size())
+      {
+        WifiScenarioConfig config = points[i].config;
+        if (config.dbPrefix != "")
+        {
+          config.dbPrefix = shardPrefix;
+        }
+        WifiScenario scenario(config);
+        WifiScenarioResults results = scenario.Run();
+        if (results.failed)
+        {
+          queue->failed.fetch_add(1);
+          std::cerr << "Worker " << k << ": point " << i + 1 << "/" << points.size()
+                    << " Trial: " << points[i].trial << " Input: " << config.input
+                    << " failed, skipped: " << results.error << std::endl;
+          continue;
+        }
+        WifiScenario::PrintMetrics(results);
+        AddPointDelays(pointDelays, points[i], results);
+        std::cerr << "Worker " << k << ": point " << i + 1 << "/" << points.size()
+                  << " Trial: " << points[i].trial << " Input: " << config.input << " done" << std::endl;
+      }
+      if (m_trials > 1 && !WritePointDelays(delayFile, pointDelays))
+      {
+        std::cerr << "Worker " << k << ": can't write " << delayFile << std::endl;
+        _exit(1);
+      }
+      std::cout.flush();
+      // _exit() skips the destructors, the shard has to be closed (and its WAL checkpointed) here
+      CloseSqliteDatabases();
+      _exit(0);
+    }
+    pids.push_back(pid);
+    delayFiles.push_back(delayFile);
+  }
+  if (pids.empty())
+  {
+    std::cout << "Can't start any worker process, running the points in this process." << std::endl;
+    munmap(shared, sizeof(SweepQueue));
+    return RunPoints(points);
+  }
+
+  bool failed = false;
+  for (auto pid : pids)
+  {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+      std::cout << "Worker process " << pid << " failed" << std::endl;
+      failed = true;
+    }
+  }
+  uint32_t count = std::min<uint32_t>(queue->next.load(), points.size());
+  m_failed = queue->failed.load();
+  munmap(shared, sizeof(SweepQueue));
+
+  // The same percentiles over the trials as a sweep in this process
+  if (m_trials > 1)
+  {
+    PointDelays pointDelays;
+    for (auto &delayFile : delayFiles)
+    {
+      if (!ReadPointDelays(delayFile, pointDelays))
+      {
+        std::cout << "Can't read the point delays of " << delayFile << std::endl;
+        failed = true;
+      }
+      std::remove(delayFile.c_str());
+    }
+    PrintPointDelays(pointDelays, m_trials);
+  }
+
+  std::vector<std::string> sqliteShards = GetWrittenShards(shards);
+  if (m_base.dbPrefix != "" && !sqliteShards.empty())
+  {
+    if (!MergeSqliteShards(sqliteShards, m_base.dbPrefix + ".db"))
+    {
+      std::cout << "Merge of the database shards failed, the shards not merged yet are kept." << std::endl;
+      failed = true;
+    }
+  }
+  std::vector<std::string> writtenColumnarShards = GetWrittenShards(columnarShards);
+  if (m_base.dbPrefix != "" && !writtenColumnarShards.empty())
+  {
+    if (!MergeColumnarShards(writtenColumnarShards, m_base.dbPrefix + ".cols"))
+    {
+      std::cout << "Merge of the columnar shards failed, the shards not merged yet are kept." << std::endl;
+      failed = true;
+    }
+  }
+  if (failed)
+  {
+    exit(1);
+  }
+  return count;
+}
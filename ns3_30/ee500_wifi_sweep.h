@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_SWEEP_H
+#define EE500_WIFI_SWEEP_H
+
+#include <string>
+#include <vector>
+
+#include "ee500_wifi_scenario.h"
+
+// One axis of the sweep grid: the parameter name and the values it takes
+struct SweepDimension
+{
+  std::string name;
+  std::vector<std::string> values;
+};
+
+// One point of the sweep grid, ready to be run
+struct SweepPoint
+{
+  uint32_t trial;
+  WifiScenarioConfig config;
+};
+
+// Runs a grid of scenarios back to back in the same process.
+// The points are the cartesian product of all dimensions, repeated for every trial.
+// Every point gets the runID "trial-value1-value2-..." and the input "name1=value1,name2=value2,...",
+// the same way wifi.sh names its runs, so the notebook can read the results without changes.
+class WifiSweep
+{
+public:
+  WifiSweep(const WifiScenarioConfig &base);
+
+  // Parses a sweep specification of the form "name1=v1:v2:v3/name2=v1:v2".
+  // The separators need no quoting in run.sh, and commas stay free for the "distances" values.
+  // Returns false if a parameter name is unknown or a value can't be parsed.
+  bool Parse(const std::string &spec);
+
+  void AddDimension(const std::string &name, const std::vector<std::string> &values);
+  void SetTrials(uint32_t trials);
+
+  // Pre-screens the points with the analytical model before running them, 0 (the default) runs all of them.
+  // A point is only simulated near a transition the model predicts: its load within the given margin of
+  // the capacity (0.5 simulates loads from 1/1.5 to 1.5), a STA within LINK_MARGIN dB of losing its link,
+  // saturated traffic, or a configuration the model doesn't cover. The others are printed with their prediction.
+  void SetPrescreen(double margin);
+
+  std::vector<SweepPoint> GetPoints() const;
+
+  // Runs all the points one after another. Returns the number of points run.
+  // With several trials, the delay percentiles of every point are also printed over all its trials.
+  // A point whose scenario fails is reported and skipped, the sweep goes on with the next one.
+  uint32_t Run();
+
+  // Runs all the points in the given number of worker processes (0 means one per core).
+  // Workers take the next point from a shared queue as soon as they are done with the previous one,
+  // the most expensive points are queued first. Every worker writes its own database shard,
+  // the shards are merged into the database of the base configuration at the end.
+  // If no worker can be started, the points are run in this process like Run() does.
+  // Returns the number of points run.
+  uint32_t RunParallel(uint32_t workers);
+
+  // Number of the points run by the last Run() or RunParallel() that failed, see WifiScenarioResults::failed
+  uint32_t GetFailed() const;
+
+  static const double LINK_MARGIN; // dB
+
+private:
+  // The points worth simulating, the skipped ones are printed
+  std::vector<SweepPoint> Prescreen(const std::vector<SweepPoint> &points) const;
+  uint32_t RunPoints(const std::vector<SweepPoint> &points);
+
+  WifiScenarioConfig m_base;
+  std::vector<SweepDimension> m_dimensions;
+  uint32_t m_trials;
+  double m_prescreen;
+  uint32_t m_failed;
+};
+
+#endif /* EE500_WIFI_SWEEP_H */
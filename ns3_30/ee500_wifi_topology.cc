@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "ee500_wifi_topology.h"
+
+//------------------------------------------------------------
+//-- WifiTopologyGenerator
+//------------------------------------------------------------
+
+void WifiTopologyGenerator::PlaceApsOnGrid(const WifiTopologyConfig &config, std::vector<Vector> &aps)
+{
+  // Columns and rows in the proportion of the area, so the cells are close to square
+  uint32_t cols = std::max<uint32_t>(1, std::round(std::sqrt(config.apNum * config.width / config.height)));
+  cols = std::min(cols, config.apNum);
+  uint32_t rows = (config.apNum + cols - 1) / cols;
+  for (uint32_t k = 0; k < config.apNum; ++k)
+  {
+    uint32_t col = k % cols;
+    uint32_t row = k / cols;
+    aps.push_back(Vector((col + 0.5) * config.width / cols, (row + 0.5) * config.height / rows, 0.0));
+  }
+}
+
+Vector WifiTopologyGenerator::UniformPosition(const WifiTopologyConfig &config, std::mt19937_64 &engine)
+{
+  std::uniform_real_distribution<double> x(0.0, config.width);
+  std::uniform_real_distribution<double> y(0.0, config.height);
+  double px = x(engine);
+  return Vector(px, y(engine), 0.0);
+}
+
+bool WifiTopologyGenerator::Validate(const WifiTopologyConfig &config, std::string &error)
+{
+  std::ostringstream out;
+  if (config.apNum == 0 || !(config.width > 0) || !(config.height > 0))
+  {
+    out << "Invalid topology: apNum=" << config.apNum << " width=" << config.width
+        << " height=" << config.height;
+  }
+  else if (config.layout == "clustered" && !(config.clusterRadius >= 0))
+  {
+    out << "Invalid clusterRadius: " << config.clusterRadius;
+  }
+  else if (config.layout == "floorplan" && !(config.roomSize > 0))
+  {
+    out << "Invalid roomSize: " << config.roomSize;
+  }
+  else if (config.layout == "floorplan")
+  {
+    // Counted in doubles, the rooms are numbered in 32 bits
+    double rooms = std::floor(config.width / config.roomSize) * std::floor(config.height / config.roomSize);
+    if (rooms < config.apNum || rooms > std::numeric_limits<uint32_t>::max())
+    {
+      out << "Invalid floorplan: " << rooms << " rooms of " << config.roomSize
+          << " m for " << config.apNum << " APs";
+    }
+  }
+  else if (config.layout != "grid" && config.layout != "random" && config.layout != "clustered")
+  {
+    out << "Unknown layout: " << config.layout;
+  }
+  error = out.str();
+  return error == "";
+}
+
+bool WifiTopologyGenerator::Generate(const WifiTopologyConfig &config, WifiTopology &topology)
+{
+  std::string error;
+  if (!Validate(config, error))
+  {
+    std::cout << error << std::endl;
+    return false;
+  }
+
+  std::mt19937_64 engine(config.seed);
+  topology.apPositions.clear();
+  topology.staPositions.clear();
+  topology.apPositions.reserve(config.apNum);
+  topology.staPositions.reserve(config.staNum);
+
+  if (config.layout == "grid")
+  {
+    PlaceApsOnGrid(config, topology.apPositions);
+    for (uint32_t i = 0; i < config.staNum; ++i)
+    {
+      topology.staPositions.push_back(UniformPosition(config, engine));
+    }
+  }
+  else if (config.layout == "random")
+  {
+    for (uint32_t k = 0; k < config.apNum; ++k)
+    {
+      topology.apPositions.push_back(UniformPosition(config, engine));
+    }
+    for (uint32_t i = 0; i < config.staNum; ++i)
+    {
+      topology.staPositions.push_back(UniformPosition(config, engine));
+    }
+  }
+  else if (config.layout == "clustered")
+  {
+    PlaceApsOnGrid(config, topology.apPositions);
+    uint32_t clusterNum = config.clusterNum > 0 ? config.clusterNum : config.apNum;
+    std::vector<Vector> centers;
+    for (uint32_t c = 0; c < clusterNum; ++c)
+    {
+      centers.push_back(UniformPosition(config, engine));
+    }
+    std::uniform_int_distribution<uint32_t> cluster(0, clusterNum - 1);
+    std::normal_distribution<double> offset(0.0, config.clusterRadius);
+    for (uint32_t i = 0; i < config.staNum; ++i)
+    {
+      const Vector &center = centers[cluster(engine)];
+      double x = center.x + offset(engine);
+      double y = center.y + offset(engine);
+      // The STAs stay inside the area, the ones beyond the edge end up on it
+      topology.staPositions.push_back(Vector(std::min(std::max(x, 0.0), config.width),
+                                             std::min(std::max(y, 0.0), config.height), 0.0));
+    }
+  }
+  else if (config.layout == "floorplan")
+  {
+    // Validate() made sure the rooms fit in 32 bits and there's one for every AP
+    uint32_t cols = static_cast<uint32_t>(config.width / config.roomSize);
+    uint32_t rows = static_cast<uint32_t>(config.height / config.roomSize);
+    uint32_t rooms = cols * rows;
+    // The APs are spread evenly over the rooms, row by row
+    for (uint32_t k = 0; k < config.apNum; ++k)
+    {
+      uint32_t room = static_cast<uint32_t>((k + 0.5) * rooms / config.apNum);
+      topology.apPositions.push_back(Vector((room % cols + 0.5) * config.roomSize,
+                                            (room / cols + 0.5) * config.roomSize, 0.0));
+    }
+    // Every STA is in a random room, at least half a meter from its walls
+    std::uniform_int_distribution<uint32_t> room(0, rooms - 1);
+    double margin = std::min(0.5, config.roomSize / 4);
+    std::uniform_real_distribution<double> inside(margin, config.roomSize - margin);
+    for (uint32_t i = 0; i < config.staNum; ++i)
+    {
+      uint32_t r = room(engine);
+      double x = (r % cols) * config.roomSize + inside(engine);
+      double y = (r / cols) * config.roomSize + inside(engine);
+      topology.staPositions.push_back(Vector(x, y, 0.0));
+    }
+  }
+
+  topology.staAps = AssociateNearest(topology.apPositions, topology.staPositions, config.width, config.height);
+  return true;
+}
+
+std::vector<uint32_t> WifiTopologyGenerator::AssociateNearest(const std::vector<Vector> &aps, const std::vector<Vector> &stas,
+                                                              double width, double height)
+{
+  std::vector<uint32_t> nearest(stas.size(), 0);
+  if (aps.size() <= 1)
+  {
+    return nearest;
+  }
+
+  // Buckets of about one AP each
+  double cell = std::sqrt(width * height / aps.size());
+  int32_t cols = std::max(1, static_cast<int32_t>(std::ceil(width / cell)));
+  int32_t rows = std::max(1, static_cast<int32_t>(std::ceil(height / cell)));
+  auto getCol = [&](double x) { return std::min(cols - 1, std::max(0, static_cast<int32_t>(x / cell))); };
+  auto getRow = [&](double y) { return std::min(rows - 1, std::max(0, static_cast<int32_t>(y / cell))); };
+
+  std::vector<std::vector<uint32_t>> buckets(cols * rows);
+  for (uint32_t k = 0; k < aps.size(); ++k)
+  {
+    buckets[getRow(aps[k].y) * cols + getCol(aps[k].x)].push_back(k);
+  }
+
+  for (uint32_t i = 0; i < stas.size(); ++i)
+  {
+    const Vector &sta = stas[i];
+    int32_t col = getCol(sta.x);
+    int32_t row = getRow(sta.y);
+    double best = std::numeric_limits<double>::max();
+    // Rings of buckets around the STA. Everything beyond ring r is at least r cells away,
+    // so the search stops once the nearest AP found is closer than that.
+    for (int32_t r = 0; r < std::max(cols, rows); ++r)
+    {
+      if (best < std::pow((r - 1) * cell, 2) && r > 1)
+      {
+        break;
+      }
+      for (int32_t y = row - r; y <= row + r; ++y)
+      {
+        for (int32_t x = col - r; x <= col + r; ++x)
+        {
+          // Only the ring itself, the inside was searched before
+          if (y < 0 || y >= rows || x < 0 || x >= cols ||
+              (std::abs(y - row) != r && std::abs(x - col) != r))
+          {
+            continue;
+          }
+          for (uint32_t k : buckets[y * cols + x])
+          {
+            double dx = aps[k].x - sta.x;
+            double dy = aps[k].y - sta.y;
+            double d2 = dx * dx + dy * dy;
+            // Ties go to the lowest AP index, whatever order the buckets are searched in
+            if (d2 < best || (d2 == best && k < nearest[i]))
+            {
+              best = d2;
+              nearest[i] = k;
+            }
+          }
+        }
+      }
+    }
+  }
+  return nearest;
+}
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ *  Authors: Andrey Golovanov, Jul 2023 for EE500 at DCU <networmix@gmail.com>
+ *
+ */
+
+#ifndef EE500_WIFI_TOPOLOGY_H
+#define EE500_WIFI_TOPOLOGY_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+// Parameters of a generated topology. The area spans (0, 0) to (width, height), in meters.
+struct WifiTopologyConfig
+{
+  std::string layout = "grid"; // [grid|random|clustered|floorplan]
+  uint32_t apNum = 1;
+  uint32_t staNum = 1;
+  double width = 100;
+  double height = 100;
+  uint32_t clusterNum = 0;     // clusters of STAs of the clustered layout, 0 means one per AP
+  double clusterRadius = 5;    // standard deviation of the STA offsets from their cluster center
+  double roomSize = 10;        // side of the square rooms of the floorplan layout
+  uint64_t seed = 1;           // the same seed gives the same topology
+};
+
+// Positions of the APs and the STAs, and the AP every STA associates with
+struct WifiTopology
+{
+  std::vector<Vector> apPositions;
+  std::vector<Vector> staPositions;
+  std::vector<uint32_t> staAps;  // index of the AP of every STA
+};
+
+// Generates multi-AP topologies:
+//   grid       APs in the middle of the cells of a near-square grid, STAs uniform over the area
+//   random     APs and STAs uniform over the area
+//   clustered  APs on the grid, STAs in clusters around uniform random centers (hot spots)
+//   floorplan  the area is split into rooms, the APs are spread over the rooms, in the middle of
+//              their room, and every STA is somewhere in a random room
+// Every STA associates with the nearest AP. The APs are bucketed in a uniform grid, so the
+// nearest AP is found by looking at the buckets around the STA, and the generation stays linear
+// in the number of nodes. The generator has its own random number engine, so the topology only
+// depends on the seed and not on the streams of the simulation.
+class WifiTopologyGenerator
+{
+public:
+  // Returns false and what's wrong in error if the parameters are invalid
+  static bool Validate(const WifiTopologyConfig &config, std::string &error);
+
+  // Prints what's wrong and returns false if the parameters are invalid
+  static bool Generate(const WifiTopologyConfig &config, WifiTopology &topology);
+
+  // Index of the AP nearest to every position
+  static std::vector<uint32_t> AssociateNearest(const std::vector<Vector> &aps, const std::vector<Vector> &stas,
+                                                double width, double height);
+
+private:
+  static void PlaceApsOnGrid(const WifiTopologyConfig &config, std::vector<Vector> &aps);
+  static Vector UniformPosition(const WifiTopologyConfig &config, std::mt19937_64 &engine);
+};
+
+#endif /* EE500_WIFI_TOPOLOGY_H */
@@ -6,7 +6,7 @@ export NS_LOG=  # clear enabled logging
 # export 'NS_LOG=*=level_all|prefix_func|prefix_time'  # for debug
 
 # Clean-up previous runs. Delete *.txt, *.pcap, *.db files if any.
-rm -f *.txt *.pcap *.db
+rm -f *.txt *.pcap *.db *.db-wal *.db-shm
 
 CWD="$PWD"
 BASE=$(basename "$PWD")
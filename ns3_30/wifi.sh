@@ -8,39 +8,46 @@ INPUT_NAME2=""
 INPUT2=""
 TRIALS=1
 DURATION=30
+FRESH=0
+APPEND=0
 
 # INPUT_NAME and INPUT can be given as command line argument in the following way:
 # ./wifi.sh input_name1=desiredDataRate input1="1000 2000 5000 10000 15000 30000" input_name2=distance input2="0 10 20 30 40" trials=1 duration=30
+# An existing data.db needs --fresh to delete it before the batch, or --append to add the runs to it.
 # Otherwise, the default values are used. Remaining arguments are passed to the simulation.
 
+# Every argument is shifted out and the ones that aren't the script's own are put back at the end,
+# so "$@" ends up with the arguments of the simulation in their order
 for arg in "$@"
 do
+  shift
   case $arg in
     --input_name1=*)
       INPUT_NAME1="${arg#*=}"
-      shift
       ;;
     --input1=*)
       INPUT1="${arg#*=}"
-      shift
       ;;
     --input_name2=*)
       INPUT_NAME2="${arg#*=}"
-      shift
       ;;
     --input2=*)
       INPUT2="${arg#*=}"
-      shift
       ;;
     --trials=*)
       TRIALS="${arg#*=}"
-      shift
       ;;
     --duration=*)
       DURATION="${arg#*=}"
-      shift
+      ;;
+    --fresh)
+      FRESH=1
+      ;;
+    --append)
+      APPEND=1
       ;;
     *)
+      set -- "$@" "$arg"
       ;;
   esac
 done
@@ -50,19 +57,23 @@ echo "Input name: $INPUT_NAME"
 echo "Inputs: $INPUTS"
 echo "Trials: $TRIALS"
 echo "Duration: $DURATION"
+echo "Fresh data.db: $FRESH"
+echo "Append to data.db: $APPEND"
 echo "Remaining arguments: $@"
 
-# Check if data.db exists and ask if it should be deleted.
-if [ -e ./data.db ]
+# Runs are never mixed into an earlier batch by accident
+if [ "$FRESH" = "1" ] && [ "$APPEND" = "1" ]
+then
+  echo "--fresh and --append can't be used together."
+  exit 1
+fi
+if [ "$FRESH" = "1" ]
+then
+  rm -f data.db data.db-wal data.db-shm
+elif [ -e data.db ] && [ "$APPEND" != "1" ]
 then
-  echo
-  echo "data.db already exists."
-  echo "Kill data.db? (y/n)"
-  read answer
-  if [ "$answer" = "y" ]
-  then
-    rm data.db
-  fi
+  echo "data.db already exists. Add --fresh to delete it first or --append to add the runs to it."
+  exit 1
 fi
 
 # Clean-up previous runs.